@@ -0,0 +1,163 @@
+/*
+ * bench_blit.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+ * Times the blit kernels against the per-pixel loops main.c used before them, on the shapes the
+ * game actually draws. Both run on the host CPU, so only the ratio means anything for the target.
+ *
+ *   enginaator_bench_blit [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "blit.h"
+
+#define SCREEN_WIDTH  320
+#define SCREEN_HEIGHT 240
+
+#define SET_FRAME_BUF_PIXEL(buf,x,y,color) *((buf) + (x) + (320*(y)))=color
+
+typedef struct
+{
+    const char * name;
+    int x;
+    int y;
+    int width;
+    int height;
+} shape_t;
+
+static uint16_t priv_frame_buffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+static uint16_t priv_sprite[SCREEN_WIDTH * SCREEN_HEIGHT];
+static volatile uint32_t priv_sink;
+
+/* The loops below are the old drawRectangleInFrameBuf() and drawBmpPartInFrameBuf() bodies. */
+static void legacy_fill(int xPos, int yPos, int width, int height, uint16_t color)
+{
+    for (int x = xPos; ((x < (xPos+width)) && (x < 320)); x++)
+    {
+        for (int y = yPos; ((y < (yPos+height)) && (y < 240)); y++)
+        {
+            SET_FRAME_BUF_PIXEL(priv_frame_buffer, x, y, color);
+        }
+    }
+}
+
+
+static void legacy_copy(int xPos, int yPos, int width, int height, uint16_t * data_buf, int clipX, int clipY, int clipWidth, int clipHeight)
+{
+    uint16_t * data_ptr = data_buf;
+
+    for (int x = xPos; (x < (xPos + width)); x++)
+    {
+        for (int y = yPos; (y < (yPos + height)); y++)
+        {
+            if ((x >= clipX) && (x < (clipX + clipWidth)) && (y >= clipY) && (y < (clipY + clipHeight)) &&
+                (x >= 0) && (x < SCREEN_WIDTH) && (y >= 0) && (y < SCREEN_HEIGHT))
+            {
+                SET_FRAME_BUF_PIXEL(priv_frame_buffer, x, y, *data_ptr);
+            }
+            data_ptr++;
+        }
+    }
+}
+
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+
+static void report(const char * op, const shape_t * shape, double legacy_ns, double blit_ns, int iterations)
+{
+    double pixels = (double)shape->width * shape->height;
+
+    printf("%-6s %-13s %8.1f %8.1f %8.2f %8.2fx\n", op, shape->name,
+           legacy_ns / iterations, blit_ns / iterations,
+           (pixels * iterations * 1e3) / blit_ns, legacy_ns / blit_ns);
+}
+
+
+int main(int argc, char ** argv)
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : 20000;
+    blit_surface_t surface = { .pixels = priv_frame_buffer, .width = SCREEN_WIDTH, .height = SCREEN_HEIGHT, .stride = SCREEN_WIDTH };
+    const shape_t shapes[] =
+    {
+        { "cell 20x20",   40,  60,  20,  20 },
+        { "button 100x40", 50,  50, 100,  40 },
+        { "logo 156x40",  82, 100, 156,  40 },
+        { "edge 20x20",  310, 230,  20,  20 },
+        { "screen",        0,   0, 320, 240 },
+    };
+
+    for (int ix = 0; ix < (SCREEN_WIDTH * SCREEN_HEIGHT); ix++)
+    {
+        /* Every fourth pixel is the key colour, so the keyed kernel branches both ways. */
+        priv_sprite[ix] = ((ix & 3) == 0) ? 0xFFFFu : (uint16_t)ix;
+    }
+
+    printf("%d iterations, times in ns per call, throughput in Mpixel/s\n", iterations);
+    printf("%-6s %-13s %8s %8s %8s %9s\n", "op", "shape", "legacy", "blit", "Mpix/s", "speedup");
+
+    for (size_t s = 0; s < (sizeof(shapes) / sizeof(shapes[0])); s++)
+    {
+        const shape_t * sh = &shapes[s];
+        blit_rect_t clip = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+        double t0, t1, t2;
+
+        t0 = now_ns();
+        for (int i = 0; i < iterations; i++)
+        {
+            legacy_fill(sh->x, sh->y, sh->width, sh->height, (uint16_t)i);
+        }
+        t1 = now_ns();
+        for (int i = 0; i < iterations; i++)
+        {
+            blit_fill(&surface, sh->x, sh->y, sh->width, sh->height, (uint16_t)i);
+        }
+        t2 = now_ns();
+        priv_sink += priv_frame_buffer[(sh->y % SCREEN_HEIGHT) * SCREEN_WIDTH];
+        report("fill", sh, t1 - t0, t2 - t1, iterations);
+
+        t0 = now_ns();
+        for (int i = 0; i < iterations; i++)
+        {
+            legacy_copy(sh->x, sh->y, sh->width, sh->height, priv_sprite, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+        }
+        t1 = now_ns();
+        for (int i = 0; i < iterations; i++)
+        {
+            blit_copy(&surface, sh->x, sh->y, sh->width, sh->height, priv_sprite, &clip);
+        }
+        t2 = now_ns();
+        priv_sink += priv_frame_buffer[(sh->y % SCREEN_HEIGHT) * SCREEN_WIDTH];
+        report("copy", sh, t1 - t0, t2 - t1, iterations);
+
+        /* There was no keyed loop before, the plain copy is the baseline it has to stay close to. */
+        t0 = now_ns();
+        for (int i = 0; i < iterations; i++)
+        {
+            legacy_copy(sh->x, sh->y, sh->width, sh->height, priv_sprite, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+        }
+        t1 = now_ns();
+        for (int i = 0; i < iterations; i++)
+        {
+            blit_copyKeyed(&surface, sh->x, sh->y, sh->width, sh->height, priv_sprite, 0xFFFFu, &clip);
+        }
+        t2 = now_ns();
+        priv_sink += priv_frame_buffer[(sh->y % SCREEN_HEIGHT) * SCREEN_WIDTH];
+        report("keyed", sh, t1 - t0, t2 - t1, iterations);
+    }
+
+    return 0;
+}
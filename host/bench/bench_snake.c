@@ -0,0 +1,232 @@
+/*
+ * bench_snake.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+ * Times a step, a grow and a self-collision check of the ring buffer snake body against the
+ * shifted array main.c used before it, at snake lengths 10, 100 and 192 (the whole grid). The
+ * snake runs round a cycle through every cell, so it can keep moving at full length.
+ *
+ *   enginaator_bench_snake [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "snakeBody.h"
+
+/* Number of bodies grown side by side, so a single grow is long enough to time. */
+#define GROW_BODIES 1000
+
+struct SnakeSegment
+{
+    int x;
+    int y;
+};
+
+/* The old body: a plain array, shifted by one on every step and scanned for self hits. */
+typedef struct
+{
+    struct SnakeSegment body[GRID_CELLS];
+    int length;
+    struct SnakeSegment vacated;
+} legacy_snake_t;
+
+static grid_cell_t priv_cycle[GRID_CELLS];
+static snakeBody_t priv_ring_bodies[GROW_BODIES];
+static legacy_snake_t priv_legacy_bodies[GROW_BODIES];
+static volatile uint32_t priv_sink;
+
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+
+/* Along the top row, down the rest of the board in a zig-zag that leaves the first column free,
+ * then back up the first column. */
+static void build_cycle(void)
+{
+    int n = 0;
+
+    for (unsigned col = 0; col < GRID_COLUMNS; col++)
+    {
+        priv_cycle[n++] = GRID_CELL(col, 0u);
+    }
+
+    for (unsigned row = 1; row < GRID_ROWS; row++)
+    {
+        for (unsigned ix = 1; ix < GRID_COLUMNS; ix++)
+        {
+            unsigned col = (row & 1u) ? (GRID_COLUMNS - ix) : ix;
+            priv_cycle[n++] = GRID_CELL(col, row);
+        }
+    }
+
+    for (unsigned row = GRID_ROWS - 1u; row >= 1u; row--)
+    {
+        priv_cycle[n++] = GRID_CELL(0u, row);
+    }
+}
+
+
+static struct SnakeSegment cell_position(grid_cell_t cell)
+{
+    struct SnakeSegment p = { (int)GRID_CELL_COLUMN(cell) * 20, (int)GRID_CELL_ROW(cell) * 20 };
+    return p;
+}
+
+
+static void legacy_step(legacy_snake_t *s, grid_cell_t new_head)
+{
+    s->vacated = s->body[s->length - 1];
+
+    for (int i = s->length - 1; i > 0; i--)
+    {
+        s->body[i].x = s->body[i - 1].x;
+        s->body[i].y = s->body[i - 1].y;
+    }
+
+    s->body[0] = cell_position(new_head);
+}
+
+
+static bool legacy_hit_itself(const legacy_snake_t *s)
+{
+    for (int i = 1; i < s->length; i++)
+    {
+        if ((s->body[0].x == s->body[i].x) && (s->body[0].y == s->body[i].y))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+static void legacy_grow(legacy_snake_t *s)
+{
+    s->length += 1;
+    s->body[s->length - 1] = s->vacated;
+}
+
+
+/* Lays both bodies along the cycle, tail on its first cell and length segments long. */
+static void lay_out(snakeBody_t *ring, legacy_snake_t *legacy, int length)
+{
+    snakeBody_reset(ring, priv_cycle[0]);
+    legacy->length = 1;
+    legacy->body[0] = cell_position(priv_cycle[0]);
+
+    for (int ix = 1; ix < length; ix++)
+    {
+        if (!snakeBody_move(ring, priv_cycle[ix]) || !snakeBody_grow(ring))
+        {
+            fprintf(stderr, "cannot lay out a snake of %d\n", length);
+            exit(EXIT_FAILURE);
+        }
+        legacy_step(legacy, priv_cycle[ix]);
+        legacy_grow(legacy);
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : 1000000;
+    const int lengths[] = { 10, 100, GRID_CELLS };
+    snakeBody_t ring;
+    legacy_snake_t legacy;
+
+    build_cycle();
+
+    printf("%d iterations, ns per operation\n", iterations);
+    printf("%6s %12s %12s %12s %12s %12s %12s\n", "length",
+           "step old", "step ring", "hit old", "hit ring", "grow old", "grow ring");
+
+    for (size_t l = 0; l < (sizeof(lengths) / sizeof(lengths[0])); l++)
+    {
+        int length = lengths[l];
+        double step_old, step_ring, hit_old, hit_ring, grow_old, grow_ring;
+        double t0, t1;
+        int pos = length;
+
+        /* Step, then check the new head against the body, as the game does every frame. */
+        lay_out(&ring, &legacy, length);
+        t0 = now_ns();
+        for (int i = 0; i < iterations; i++)
+        {
+            legacy_step(&legacy, priv_cycle[(length + i) % GRID_CELLS]);
+        }
+        t1 = now_ns();
+        step_old = (t1 - t0) / iterations;
+
+        t0 = now_ns();
+        for (int i = 0; i < iterations; i++)
+        {
+            priv_sink += legacy_hit_itself(&legacy);
+        }
+        t1 = now_ns();
+        hit_old = (t1 - t0) / iterations;
+
+        t0 = now_ns();
+        for (int i = 0; i < iterations; i++)
+        {
+            if (!snakeBody_move(&ring, priv_cycle[pos]))
+            {
+                fprintf(stderr, "the ring body hit itself at length %d\n", length);
+                return EXIT_FAILURE;
+            }
+            pos = (pos + 1) % GRID_CELLS;
+        }
+        t1 = now_ns();
+        step_ring = (t1 - t0) / iterations;
+
+        /* snakeBody_move() does this check itself, timed on its own for comparison. */
+        t0 = now_ns();
+        for (int i = 0; i < iterations; i++)
+        {
+            priv_sink += snakeBody_isOccupied(&ring, priv_cycle[i % GRID_CELLS]);
+        }
+        t1 = now_ns();
+        hit_ring = (t1 - t0) / iterations;
+
+        /* Grows from length - 1 to length, right after a step. */
+        for (int b = 0; b < GROW_BODIES; b++)
+        {
+            lay_out(&priv_ring_bodies[b], &priv_legacy_bodies[b], length - 1);
+            snakeBody_move(&priv_ring_bodies[b], priv_cycle[(length - 1) % GRID_CELLS]);
+            legacy_step(&priv_legacy_bodies[b], priv_cycle[(length - 1) % GRID_CELLS]);
+        }
+
+        t0 = now_ns();
+        for (int b = 0; b < GROW_BODIES; b++)
+        {
+            legacy_grow(&priv_legacy_bodies[b]);
+        }
+        t1 = now_ns();
+        grow_old = (t1 - t0) / GROW_BODIES;
+
+        t0 = now_ns();
+        for (int b = 0; b < GROW_BODIES; b++)
+        {
+            priv_sink += snakeBody_grow(&priv_ring_bodies[b]);
+        }
+        t1 = now_ns();
+        grow_ring = (t1 - t0) / GROW_BODIES;
+
+        printf("%6d %12.2f %12.2f %12.2f %12.2f %12.2f %12.2f\n", length,
+               step_old, step_ring, hit_old, hit_ring, grow_old, grow_ring);
+    }
+
+    return EXIT_SUCCESS;
+}
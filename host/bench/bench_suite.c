@@ -0,0 +1,548 @@
+/*
+ * bench_suite.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+ * Times the hot paths of the game on the simulated board and prints one CSV line per case, so a
+ * run can be diffed against the run from the previous commit:
+ *
+ *   benchmark,case,iterations,ns_per_op,sim_us_per_op
+ *
+ * ns_per_op is host CPU time of the benchmark task, which leaves out the time it spends blocked.
+ * sim_us_per_op is the simulated board time, the SD card and SPI transfers the case waited for.
+ * Each case runs until it has used BENCH_MIN_CPU_NS or reached its iteration cap.
+ *
+ * The drawing functions in render.c, the BMP reader in sdCard.c and the snake in main.c are
+ * private, so their cases call what those are built on: blit_fill() for drawRectangleInFrameBuf(),
+ * blit_copy(), blit_copyKeyed() and blit_copyIndexed() for the RGB565, keyed and indexed sprites of
+ * drawSpriteInFrameBuf(), blit_copyRuns() for its sprites with a run table, sdCard_Read_bmp_file() for read_bmp_file(), and
+ * snakeBody_move() / snakeBody_isOccupied() for updateSnakePosition() and snakeCollision().
+ * A whole frame goes through render_drawSnapshot(), as drawSnakeGame() did before the render task.
+ *
+ *   enginaator_bench --sdcard DIR [--quiet] > bench.csv
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+#include "display.h"
+#include "spiBus.h"
+#include "sdCard.h"
+#include "assets.h"
+#include "blit.h"
+#include "snakeBody.h"
+#include "gameSnapshot.h"
+#include "render.h"
+#include "level.h"
+
+#include "sim.h"
+
+#define BENCH_MIN_CPU_NS    50000000u
+#define BENCH_MAX_BMP_FILES 64
+#define BENCH_RUNS_SIZE     1024u
+
+typedef struct
+{
+    const char * name;
+    int x;
+    int y;
+    int width;
+    int height;
+} shape_t;
+
+typedef void (*bench_fn_t)(void * arg, uint32_t iteration);
+
+static const shape_t priv_shapes[] =
+{
+    { "cell 20x20",     40,  60,  20,  20 },
+    { "button 100x40",  50,  50, 100,  40 },
+    { "logo 156x40",    82, 100, 156,  40 },
+    { "edge 20x20",    310, 230,  20,  20 },
+    { "screen",          0,   0, 320, 240 },
+};
+
+static FILE * priv_csv;
+static uint16_t priv_frame_buffer[DISPLAY_WIDTH * DISPLAY_HEIGHT];
+static uint16_t priv_sprite[DISPLAY_WIDTH * DISPLAY_HEIGHT];
+static uint8_t priv_indices[DISPLAY_WIDTH * DISPLAY_HEIGHT];
+static uint16_t priv_palette[256];
+static uint8_t priv_rgb565_runs[BENCH_RUNS_SIZE];
+static uint8_t priv_indexed_runs[BENCH_RUNS_SIZE];
+static uint8_t priv_bgr_line[DISPLAY_WIDTH * 3u];
+static uint16_t priv_rgb565_line[DISPLAY_WIDTH];
+static grid_cell_t priv_cycle[GRID_CELLS];
+static snakeBody_t priv_snake;
+static uint32_t priv_snake_head;
+static game_snapshot_t priv_snapshot;
+static volatile uint32_t priv_sink;
+
+
+static uint64_t thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+
+/* Runs fn in batches that double in size until the case has used BENCH_MIN_CPU_NS or
+ * max_iterations, then prints its line. */
+static void run_case(const char * benchmark, const char * name, bench_fn_t fn, void * arg, uint32_t max_iterations)
+{
+    uint32_t iterations = 0u;
+    uint32_t batch = 1u;
+    uint64_t start_ns = thread_cpu_ns();
+    int64_t start_us = esp_timer_get_time();
+    uint64_t cpu_ns;
+
+    do
+    {
+        batch = (batch < (max_iterations - iterations)) ? batch : (max_iterations - iterations);
+        for (uint32_t ix = 0u; ix < batch; ix++)
+        {
+            fn(arg, iterations + ix);
+        }
+        iterations += batch;
+        batch *= 2u;
+        cpu_ns = thread_cpu_ns() - start_ns;
+    } while ((cpu_ns < BENCH_MIN_CPU_NS) && (iterations < max_iterations));
+
+    fprintf(priv_csv, "%s,%s,%u,%.1f,%.1f\n", benchmark, name, (unsigned)iterations,
+            (double)cpu_ns / iterations, (double)(esp_timer_get_time() - start_us) / iterations);
+    fflush(priv_csv);
+}
+
+
+static void bench_fill(void * arg, uint32_t iteration)
+{
+    const shape_t * shape = arg;
+    blit_surface_t surface = { .pixels = priv_frame_buffer, .width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT, .stride = DISPLAY_WIDTH };
+
+    blit_fill(&surface, shape->x, shape->y, shape->width, shape->height, (uint16_t)iteration);
+}
+
+
+static void bench_copy(void * arg, uint32_t iteration)
+{
+    const shape_t * shape = arg;
+    blit_surface_t surface = { .pixels = priv_frame_buffer, .width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT, .stride = DISPLAY_WIDTH };
+
+    (void)iteration;
+    blit_copy(&surface, shape->x, shape->y, shape->width, shape->height, priv_sprite, NULL);
+}
+
+
+static void bench_copy_keyed(void * arg, uint32_t iteration)
+{
+    const shape_t * shape = arg;
+    blit_surface_t surface = { .pixels = priv_frame_buffer, .width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT, .stride = DISPLAY_WIDTH };
+
+    (void)iteration;
+    blit_copyKeyed(&surface, shape->x, shape->y, shape->width, shape->height, priv_sprite, ASSET_COLOR_KEY, NULL);
+}
+
+
+static void bench_copy_indexed4(void * arg, uint32_t iteration)
+{
+    const shape_t * shape = arg;
+    blit_surface_t surface = { .pixels = priv_frame_buffer, .width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT, .stride = DISPLAY_WIDTH };
+
+    (void)iteration;
+    blit_copyIndexed(&surface, shape->x, shape->y, shape->width, shape->height, priv_indices, 4u, priv_palette, false, NULL);
+}
+
+
+static void bench_copy_indexed4_keyed(void * arg, uint32_t iteration)
+{
+    const shape_t * shape = arg;
+    blit_surface_t surface = { .pixels = priv_frame_buffer, .width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT, .stride = DISPLAY_WIDTH };
+
+    (void)iteration;
+    blit_copyIndexed(&surface, shape->x, shape->y, shape->width, shape->height, priv_indices, 4u, priv_palette, true, NULL);
+}
+
+
+static void bench_copy_indexed8(void * arg, uint32_t iteration)
+{
+    const shape_t * shape = arg;
+    blit_surface_t surface = { .pixels = priv_frame_buffer, .width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT, .stride = DISPLAY_WIDTH };
+
+    (void)iteration;
+    blit_copyIndexed(&surface, shape->x, shape->y, shape->width, shape->height, priv_indices, 8u, priv_palette, false, NULL);
+}
+
+
+/* Draws the run bitmaps that build_ellipse() made, over the same pixels as the keyed cases. */
+static void bench_copy_runs(void * arg, uint32_t iteration)
+{
+    const shape_t * shape = arg;
+    blit_surface_t surface = { .pixels = priv_frame_buffer, .width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT, .stride = DISPLAY_WIDTH };
+
+    (void)iteration;
+    blit_copyRuns(&surface, shape->x, shape->y, shape->width, shape->height, priv_sprite, 16u, NULL, priv_rgb565_runs, NULL);
+}
+
+
+static void bench_copy_indexed4_runs(void * arg, uint32_t iteration)
+{
+    const shape_t * shape = arg;
+    blit_surface_t surface = { .pixels = priv_frame_buffer, .width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT, .stride = DISPLAY_WIDTH };
+
+    (void)iteration;
+    blit_copyRuns(&surface, shape->x, shape->y, shape->width, shape->height, priv_indices, 4u, priv_palette, priv_indexed_runs, NULL);
+}
+
+
+/* Fills priv_sprite and priv_indices with an ellipse the size of the shape on a transparent
+ * background, the way the fruit sprites look, and encodes their run tables. */
+static bool build_ellipse(const shape_t * shape)
+{
+    uint32_t row_bytes = BLIT_INDEXED_ROW_BYTES((uint32_t)shape->width, 4u);
+
+    memset(priv_indices, 0, row_bytes * shape->height);
+
+    for (int y = 0; y < shape->height; y++)
+    {
+        for (int x = 0; x < shape->width; x++)
+        {
+            int dx = (2 * x) + 1 - shape->width;
+            int dy = (2 * y) + 1 - shape->height;
+            bool inside = ((dx * dx * shape->height * shape->height) + (dy * dy * shape->width * shape->width)) <=
+                          (shape->width * shape->width * shape->height * shape->height);
+            uint8_t index = inside ? (uint8_t)(1u + ((x + y) % 15)) : 0u;
+
+            priv_sprite[(y * shape->width) + x] = inside ? (uint16_t)(x + y) : ASSET_COLOR_KEY;
+            priv_indices[(y * row_bytes) + (x >> 1)] |= (uint8_t)(index << ((x & 1) ? 0 : 4));
+        }
+    }
+
+    return (blit_encodeRuns(priv_sprite, shape->width, shape->height, 16u, ASSET_COLOR_KEY,
+                            priv_rgb565_runs, sizeof(priv_rgb565_runs)) > 0u) &&
+           (blit_encodeRuns(priv_indices, shape->width, shape->height, 4u, ASSET_COLOR_KEY,
+                            priv_indexed_runs, sizeof(priv_indexed_runs)) > 0u);
+}
+
+
+/* The loop of convert_bmp_line() in sdCard.c. */
+static void bench_convert_line(void * arg, uint32_t iteration)
+{
+    const uint8_t * src = priv_bgr_line;
+
+    (void)arg;
+    for (uint32_t x = 0u; x < DISPLAY_WIDTH; x++)
+    {
+        priv_rgb565_line[x] = CONVERT_888RGB_TO_565RGB(src[2], src[1], src[0]);
+        src += 3;
+    }
+    priv_sink += priv_rgb565_line[iteration % DISPLAY_WIDTH];
+}
+
+
+typedef struct
+{
+    char path[48];
+    uint16_t width;
+    uint16_t height;
+} bmp_case_t;
+
+static void bench_read_bmp(void * arg, uint32_t iteration)
+{
+    const bmp_case_t * bmp = arg;
+
+    (void)iteration;
+    if (sdCard_Read_bmp_file(bmp->path, priv_sprite, bmp->width, bmp->height) != ESP_OK)
+    {
+        fprintf(stderr, "bench: cannot read %s\n", bmp->path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/* Along the top row, down the rest of the board in a zig-zag that leaves the first column free,
+ * then back up the first column. The snake can go round it forever at any length. */
+static void build_cycle(void)
+{
+    int n = 0;
+
+    for (unsigned col = 0; col < GRID_COLUMNS; col++)
+    {
+        priv_cycle[n++] = GRID_CELL(col, 0u);
+    }
+
+    for (unsigned row = 1; row < GRID_ROWS; row++)
+    {
+        for (unsigned ix = 1; ix < GRID_COLUMNS; ix++)
+        {
+            unsigned col = (row & 1u) ? (GRID_COLUMNS - ix) : ix;
+            priv_cycle[n++] = GRID_CELL(col, row);
+        }
+    }
+
+    for (unsigned row = GRID_ROWS - 1u; row >= 1u; row--)
+    {
+        priv_cycle[n++] = GRID_CELL(0u, row);
+    }
+}
+
+
+static void lay_out_snake(int length)
+{
+    snakeBody_reset(&priv_snake, priv_cycle[0]);
+
+    for (int ix = 1; ix < length; ix++)
+    {
+        (void)snakeBody_move(&priv_snake, priv_cycle[ix]);
+        (void)snakeBody_grow(&priv_snake);
+    }
+
+    priv_snake_head = (uint32_t)(length - 1);
+}
+
+
+static void bench_snake_move(void * arg, uint32_t iteration)
+{
+    (void)arg;
+    (void)iteration;
+    priv_snake_head = (priv_snake_head + 1u) % GRID_CELLS;
+    priv_sink += snakeBody_move(&priv_snake, priv_cycle[priv_snake_head]);
+}
+
+
+static void bench_snake_occupied(void * arg, uint32_t iteration)
+{
+    (void)arg;
+    priv_sink += snakeBody_isOccupied(&priv_snake, (grid_cell_t)(iteration % GRID_CELLS));
+}
+
+
+/* Food on one cell and a snake of 20 going round the cycle. */
+static void fill_game_snapshot(uint32_t head)
+{
+    memset(priv_snapshot.cells, SNAPSHOT_CELL_EMPTY, sizeof(priv_snapshot.cells));
+    priv_snapshot.sequence++;
+    priv_snapshot.screen = SNAPSHOT_SCREEN_GAME;
+    priv_snapshot.level = 1u;
+    priv_snapshot.cells[GRID_CELL(GRID_COLUMNS / 2u, GRID_ROWS / 2u)] = ASSET_APPLE;
+
+    for (uint32_t ix = 1u; ix < 20u; ix++)
+    {
+        priv_snapshot.cells[priv_cycle[(head + GRID_CELLS - ix) % GRID_CELLS]] = ASSET_SNAKE_BODY;
+    }
+    priv_snapshot.cells[priv_cycle[head % GRID_CELLS]] = ASSET_SNAKE_HEAD;
+}
+
+
+/* A new scene every time, so the whole level is drawn and sent. */
+static void bench_frame_level(void * arg, uint32_t iteration)
+{
+    (void)arg;
+    fill_game_snapshot(iteration);
+    priv_snapshot.scene++;
+    render_drawSnapshot(&priv_snapshot, SPI_BUS_NO_DEADLINE);
+}
+
+
+/* One snake step, so only the changed cells are drawn and sent. */
+static void bench_frame_step(void * arg, uint32_t iteration)
+{
+    (void)arg;
+    fill_game_snapshot(iteration);
+    render_drawSnapshot(&priv_snapshot, SPI_BUS_NO_DEADLINE);
+}
+
+
+static int compare_bmp_cases(const void * a, const void * b)
+{
+    return strcmp(((const bmp_case_t *)a)->path, ((const bmp_case_t *)b)->path);
+}
+
+
+/* The BMPs in the root and in /images of the card, with the size from their headers, sorted so
+ * the lines come in the same order on every host. */
+static int find_bmps(bmp_case_t * cases, int max_cases)
+{
+    const char * dirs[] = { "", "/images" };
+    int count = 0;
+
+    for (size_t d = 0; d < (sizeof(dirs) / sizeof(dirs[0])); d++)
+    {
+        char host_dir[512];
+        struct dirent * entry;
+        DIR * dir;
+
+        snprintf(host_dir, sizeof(host_dir), "%s%s", sim_sdcard_get_root(), dirs[d]);
+        dir = opendir(host_dir);
+        if (dir == NULL)
+        {
+            continue;
+        }
+
+        while (((entry = readdir(dir)) != NULL) && (count < max_cases))
+        {
+            size_t len = strlen(entry->d_name);
+            char host_path[1024];
+            uint8_t header[26];
+            int fd;
+
+            if ((len < 5u) || (len >= (sizeof(cases[count].path) - 8u)) || (strcmp(&entry->d_name[len - 4u], ".bmp") != 0))
+            {
+                continue;
+            }
+
+            /* Read past the simulated card, fopen() is the card's here. */
+            snprintf(host_path, sizeof(host_path), "%s/%s", host_dir, entry->d_name);
+            fd = open(host_path, O_RDONLY);
+            if (fd < 0)
+            {
+                continue;
+            }
+            if (read(fd, header, sizeof(header)) == (ssize_t)sizeof(header))
+            {
+                /* Little endian width and height at 18 and 22, bottom-up images are the usual case. */
+                int32_t width = (int32_t)(header[18] | (header[19] << 8) | (header[20] << 16) | ((uint32_t)header[21] << 24));
+                int32_t height = (int32_t)(header[22] | (header[23] << 8) | (header[24] << 16) | ((uint32_t)header[25] << 24));
+
+                height = (height < 0) ? -height : height;
+                if ((width > 0) && (width <= (int32_t)DISPLAY_WIDTH) && (height > 0) && (height <= (int32_t)DISPLAY_HEIGHT))
+                {
+                    snprintf(cases[count].path, sizeof(cases[count].path), "%s/%s", dirs[d], entry->d_name);
+                    cases[count].width = (uint16_t)width;
+                    cases[count].height = (uint16_t)height;
+                    count++;
+                }
+            }
+            close(fd);
+        }
+
+        closedir(dir);
+    }
+
+    qsort(cases, (size_t)count, sizeof(bmp_case_t), compare_bmp_cases);
+    return count;
+}
+
+
+void app_main(void)
+{
+    static bmp_case_t bmps[BENCH_MAX_BMP_FILES];
+    const int lengths[] = { 10, 50, 100, GRID_CELLS - 1 };
+    int bmp_count;
+
+    /* The game prints as it initializes, keep that out of the CSV. */
+    fflush(stdout);
+    priv_csv = fdopen(dup(fileno(stdout)), "w");
+    if ((priv_csv == NULL) || (freopen("/dev/null", "w", stdout) == NULL))
+    {
+        return;
+    }
+
+    /* Run until the benchmarks are done, not for the simulator's default duration. */
+    sim_set_end_us(INT64_MAX);
+
+    render_init();
+    if (!spiBus_init())
+    {
+        return;
+    }
+    display_init();
+    sdCard_init();
+    assets_init();
+    level_init();
+
+    for (uint32_t ix = 0u; ix < (DISPLAY_WIDTH * DISPLAY_HEIGHT); ix++)
+    {
+        /* Every fourth pixel is the key colour, so the keyed kernel branches both ways. */
+        priv_sprite[ix] = ((ix & 3u) == 0u) ? ASSET_COLOR_KEY : (uint16_t)ix;
+    }
+    for (uint32_t ix = 0u; ix < sizeof(priv_indices); ix++)
+    {
+        /* Index 0, transparent in keyed bitmaps, comes up in both nibbles now and then. */
+        priv_indices[ix] = (uint8_t)(ix * 37u);
+    }
+    for (uint32_t ix = 0u; ix < 256u; ix++)
+    {
+        priv_palette[ix] = (uint16_t)(ix * 257u);
+    }
+    for (uint32_t ix = 0u; ix < sizeof(priv_bgr_line); ix++)
+    {
+        priv_bgr_line[ix] = (uint8_t)(ix * 7u);
+    }
+    build_cycle();
+
+    fprintf(priv_csv, "benchmark,case,iterations,ns_per_op,sim_us_per_op\n");
+
+    for (size_t s = 0; s < (sizeof(priv_shapes) / sizeof(priv_shapes[0])); s++)
+    {
+        run_case("drawRectangleInFrameBuf", priv_shapes[s].name, bench_fill, (void *)&priv_shapes[s], 1000000u);
+    }
+    for (size_t s = 0; s < (sizeof(priv_shapes) / sizeof(priv_shapes[0])); s++)
+    {
+        run_case("drawBmpInFrameBuf", priv_shapes[s].name, bench_copy, (void *)&priv_shapes[s], 1000000u);
+    }
+    for (size_t s = 0; s < (sizeof(priv_shapes) / sizeof(priv_shapes[0])); s++)
+    {
+        run_case("drawSpriteInFrameBuf keyed", priv_shapes[s].name, bench_copy_keyed, (void *)&priv_shapes[s], 1000000u);
+    }
+    for (size_t s = 0; s < (sizeof(priv_shapes) / sizeof(priv_shapes[0])); s++)
+    {
+        run_case("drawSpriteInFrameBuf 4bpp", priv_shapes[s].name, bench_copy_indexed4, (void *)&priv_shapes[s], 1000000u);
+    }
+    for (size_t s = 0; s < (sizeof(priv_shapes) / sizeof(priv_shapes[0])); s++)
+    {
+        run_case("drawSpriteInFrameBuf 4bpp keyed", priv_shapes[s].name, bench_copy_indexed4_keyed, (void *)&priv_shapes[s], 1000000u);
+    }
+    for (size_t s = 0; s < (sizeof(priv_shapes) / sizeof(priv_shapes[0])); s++)
+    {
+        run_case("drawSpriteInFrameBuf 8bpp", priv_shapes[s].name, bench_copy_indexed8, (void *)&priv_shapes[s], 1000000u);
+    }
+
+    /* Run tables against the per pixel keyed loops, on sprites shaped like the real ones. The
+     * screen is too wide for a run table. */
+    for (size_t s = 0; s < (sizeof(priv_shapes) / sizeof(priv_shapes[0])); s++)
+    {
+        if (!build_ellipse(&priv_shapes[s]))
+        {
+            continue;
+        }
+        run_case("drawSpriteInFrameBuf ellipse keyed", priv_shapes[s].name, bench_copy_keyed, (void *)&priv_shapes[s], 1000000u);
+        run_case("drawSpriteInFrameBuf ellipse runs", priv_shapes[s].name, bench_copy_runs, (void *)&priv_shapes[s], 1000000u);
+        run_case("drawSpriteInFrameBuf ellipse 4bpp keyed", priv_shapes[s].name, bench_copy_indexed4_keyed, (void *)&priv_shapes[s], 1000000u);
+        run_case("drawSpriteInFrameBuf ellipse 4bpp runs", priv_shapes[s].name, bench_copy_indexed4_runs, (void *)&priv_shapes[s], 1000000u);
+    }
+
+    run_case("CONVERT_888RGB_TO_565RGB", "line 320", bench_convert_line, NULL, 10000000u);
+
+    bmp_count = find_bmps(bmps, BENCH_MAX_BMP_FILES);
+    for (int ix = 0; ix < bmp_count; ix++)
+    {
+        run_case("read_bmp_file", bmps[ix].path, bench_read_bmp, &bmps[ix], 32u);
+    }
+
+    for (size_t l = 0; l < (sizeof(lengths) / sizeof(lengths[0])); l++)
+    {
+        char name[16];
+
+        snprintf(name, sizeof(name), "length %d", lengths[l]);
+        lay_out_snake(lengths[l]);
+        run_case("updateSnakePosition", name, bench_snake_move, NULL, 10000000u);
+        lay_out_snake(lengths[l]);
+        run_case("snakeCollision", name, bench_snake_occupied, NULL, 10000000u);
+    }
+
+    run_case("drawSnakeGame", "level", bench_frame_level, NULL, 64u);
+    run_case("drawSnakeGame", "step", bench_frame_step, NULL, 1024u);
+
+    fclose(priv_csv);
+}
@@ -0,0 +1,138 @@
+/*
+ * stress_mailbox.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+ * Hammers the snapshot mailbox from two threads, the way the logic and render tasks use it but
+ * without any pacing. The producer fills every byte of each snapshot from its sequence number
+ * and the consumer checks each one it takes: a torn snapshot (a mix of two publishes) or a
+ * sequence number going backwards is a failure. Exits non-zero on the first one.
+ *
+ *   enginaator_stress_mailbox [publishes]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "mailbox.h"
+#include "gameSnapshot.h"
+
+static game_snapshot_t priv_snapshots[MAILBOX_BUFFERS];
+static mailbox_t priv_mailbox;
+static uint32_t priv_publishes = 10000000u;
+static atomic_bool priv_done = false;
+
+
+static uint8_t cell_pattern(uint32_t sequence, uint32_t cell)
+{
+    return (uint8_t)((sequence * 31u) + cell);
+}
+
+
+static void *producer(void *arg)
+{
+    (void)arg;
+
+    for (uint32_t sequence = 1u; sequence <= priv_publishes; sequence++)
+    {
+        game_snapshot_t *snapshot = mailbox_getWriteBuffer(&priv_mailbox);
+
+        snapshot->sequence = sequence;
+        snapshot->scene = ~sequence;
+        for (uint32_t cell = 0u; cell < GRID_CELLS; cell++)
+        {
+            snapshot->cells[cell] = cell_pattern(sequence, cell);
+        }
+
+        mailbox_publish(&priv_mailbox);
+    }
+
+    atomic_store(&priv_done, true);
+    return NULL;
+}
+
+
+/* Returns false if the snapshot was not written by a single publish. */
+static bool check_snapshot(const game_snapshot_t *snapshot)
+{
+    if (snapshot->scene != ~snapshot->sequence)
+    {
+        return false;
+    }
+
+    for (uint32_t cell = 0u; cell < GRID_CELLS; cell++)
+    {
+        if (snapshot->cells[cell] != cell_pattern(snapshot->sequence, cell))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    pthread_t thread;
+    uint32_t last_sequence = 0u;
+    uint64_t taken = 0u;
+    uint64_t empty_polls = 0u;
+    bool finished = false;
+
+    if (argc > 1)
+    {
+        priv_publishes = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+
+    mailbox_init(&priv_mailbox, &priv_snapshots[0], &priv_snapshots[1], &priv_snapshots[2]);
+    pthread_create(&thread, NULL, producer, NULL);
+
+    /* Check the done flag before taking, so the last publish is always seen. */
+    while (!finished)
+    {
+        const game_snapshot_t *snapshot;
+
+        finished = atomic_load(&priv_done);
+        snapshot = mailbox_take(&priv_mailbox);
+
+        if (snapshot == NULL)
+        {
+            empty_polls++;
+            continue;
+        }
+
+        if (!check_snapshot(snapshot))
+        {
+            fprintf(stderr, "FAIL: torn snapshot %u after %llu taken\n", snapshot->sequence, (unsigned long long)taken);
+            return EXIT_FAILURE;
+        }
+
+        if (snapshot->sequence <= last_sequence)
+        {
+            fprintf(stderr, "FAIL: snapshot %u taken after %u\n", snapshot->sequence, last_sequence);
+            return EXIT_FAILURE;
+        }
+
+        last_sequence = snapshot->sequence;
+        taken++;
+    }
+
+    pthread_join(thread, NULL);
+
+    if (last_sequence != priv_publishes)
+    {
+        fprintf(stderr, "FAIL: last snapshot taken was %u of %u\n", last_sequence, priv_publishes);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u published, %llu taken, %llu skipped, %llu empty polls: OK\n", priv_publishes,
+           (unsigned long long)taken, (unsigned long long)(priv_publishes - taken), (unsigned long long)empty_polls);
+    return EXIT_SUCCESS;
+}
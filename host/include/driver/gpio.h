@@ -0,0 +1,63 @@
+/*
+ * gpio.h
+ *
+ * Host stand-in for the GPIO driver. Output levels are recorded by the simulator (the panel
+ * model reads the D/C line from here), input levels come from the joystick script. Interrupt
+ * handlers are called on every edge in the script, at its time.
+ */
+
+#ifndef HOST_DRIVER_GPIO_H_
+#define HOST_DRIVER_GPIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef enum
+{
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0 = 0, GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_6,
+    GPIO_NUM_7, GPIO_NUM_8, GPIO_NUM_9, GPIO_NUM_10, GPIO_NUM_11, GPIO_NUM_12, GPIO_NUM_13,
+    GPIO_NUM_14, GPIO_NUM_15, GPIO_NUM_16, GPIO_NUM_17, GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_20,
+    GPIO_NUM_21, GPIO_NUM_MAX = 49
+} gpio_num_t;
+
+typedef enum
+{
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT = 1,
+    GPIO_MODE_OUTPUT = 2,
+    GPIO_MODE_INPUT_OUTPUT = 3,
+} gpio_mode_t;
+
+typedef enum
+{
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE = 1,
+    GPIO_INTR_NEGEDGE = 2,
+    GPIO_INTR_ANYEDGE = 3,
+} gpio_int_type_t;
+
+#define GPIO_PULLUP_DISABLE     0
+#define GPIO_PULLUP_ENABLE      1
+#define GPIO_PULLDOWN_DISABLE   0
+#define GPIO_PULLDOWN_ENABLE    1
+
+typedef void (*gpio_isr_t)(void *arg);
+
+typedef struct
+{
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    int pull_up_en;
+    int pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+extern esp_err_t gpio_config(const gpio_config_t *pGPIOConfig);
+extern esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+extern int gpio_get_level(gpio_num_t gpio_num);
+extern esp_err_t gpio_install_isr_service(int intr_alloc_flags);
+extern esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args);
+
+#endif /* HOST_DRIVER_GPIO_H_ */
@@ -0,0 +1,41 @@
+/*
+ * adc_continuous.h
+ *
+ * Host stand-in for the ESP-IDF 5 continuous (DMA) mode ADC driver. Conversions run at the
+ * configured rate on the simulated clock and their values come from the joystick script.
+ */
+
+#ifndef HOST_ESP_ADC_CONTINUOUS_H_
+#define HOST_ESP_ADC_CONTINUOUS_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "hal/adc_types.h"
+
+#define ADC_MAX_DELAY UINT32_MAX
+
+typedef struct adc_continuous_ctx_t * adc_continuous_handle_t;
+
+typedef struct
+{
+    uint32_t max_store_buf_size;
+    uint32_t conv_frame_size;
+} adc_continuous_handle_cfg_t;
+
+typedef struct
+{
+    uint32_t pattern_num;
+    adc_digi_pattern_config_t * adc_pattern;
+    uint32_t sample_freq_hz;
+    adc_digi_convert_mode_t conv_mode;
+    adc_digi_output_format_t format;
+} adc_continuous_config_t;
+
+extern esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t * hdl_config, adc_continuous_handle_t * ret_handle);
+extern esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t * config);
+extern esp_err_t adc_continuous_start(adc_continuous_handle_t handle);
+extern esp_err_t adc_continuous_stop(adc_continuous_handle_t handle);
+extern esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t * buf, uint32_t length_max,
+                                     uint32_t * out_length, uint32_t timeout_ms);
+
+#endif /* HOST_ESP_ADC_CONTINUOUS_H_ */
@@ -0,0 +1,14 @@
+/*
+ * esp_attr.h
+ *
+ * Host stand-in. Memory placement attributes have no meaning on the host.
+ */
+
+#ifndef HOST_ESP_ATTR_H_
+#define HOST_ESP_ATTR_H_
+
+#define DRAM_ATTR
+#define IRAM_ATTR
+#define EXT_RAM_BSS_ATTR
+
+#endif /* HOST_ESP_ATTR_H_ */
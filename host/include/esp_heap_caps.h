@@ -0,0 +1,29 @@
+/*
+ * esp_heap_caps.h
+ *
+ * Host stand-in for the capability based heap. Allocations are tracked by the simulator
+ * so that heap growth and the DMA-capable RAM limit of the board can be reproduced.
+ */
+
+#ifndef HOST_ESP_HEAP_CAPS_H_
+#define HOST_ESP_HEAP_CAPS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_EXEC             (1 << 0)
+#define MALLOC_CAP_32BIT            (1 << 1)
+#define MALLOC_CAP_8BIT             (1 << 2)
+#define MALLOC_CAP_DMA              (1 << 3)
+#define MALLOC_CAP_SPIRAM           (1 << 10)
+#define MALLOC_CAP_INTERNAL         (1 << 11)
+#define MALLOC_CAP_DEFAULT          (1 << 12)
+
+extern void *heap_caps_malloc(size_t size, uint32_t caps);
+extern void *heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+extern void heap_caps_free(void *ptr);
+extern size_t heap_caps_get_total_size(uint32_t caps);
+extern size_t heap_caps_get_free_size(uint32_t caps);
+extern size_t heap_caps_get_minimum_free_size(uint32_t caps);
+
+#endif /* HOST_ESP_HEAP_CAPS_H_ */
@@ -0,0 +1,21 @@
+/*
+ * esp_random.h
+ *
+ * Host stand-in. The board's random number generator is replaced with a fixed sequence, so every
+ * simulator run with the same script plays out the same way.
+ */
+
+#ifndef HOST_ESP_RANDOM_H_
+#define HOST_ESP_RANDOM_H_
+
+#include <stdint.h>
+
+static inline uint32_t esp_random(void)
+{
+    static uint32_t state = 0x2545F491u;
+
+    state = (state * 1664525u) + 1013904223u;
+    return state;
+}
+
+#endif /* HOST_ESP_RANDOM_H_ */
@@ -0,0 +1,18 @@
+/*
+ * esp_system.h
+ *
+ * Host stand-in.
+ */
+
+#ifndef HOST_ESP_SYSTEM_H_
+#define HOST_ESP_SYSTEM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+
+extern void esp_restart(void) __attribute__((noreturn));
+
+#endif /* HOST_ESP_SYSTEM_H_ */
@@ -0,0 +1,14 @@
+/*
+ * esp_task_wdt.h
+ *
+ * Host stand-in. Like the real header, pulls in the FreeRTOS task API.
+ */
+
+#ifndef HOST_ESP_TASK_WDT_H_
+#define HOST_ESP_TASK_WDT_H_
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#endif /* HOST_ESP_TASK_WDT_H_ */
@@ -0,0 +1,16 @@
+/*
+ * esp_timer.h
+ *
+ * Host stand-in. Returns microseconds of the simulated clock, which advances with
+ * task delays and with the modelled duration of SPI and SD card transfers.
+ */
+
+#ifndef HOST_ESP_TIMER_H_
+#define HOST_ESP_TIMER_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+extern int64_t esp_timer_get_time(void);
+
+#endif /* HOST_ESP_TIMER_H_ */
@@ -0,0 +1,66 @@
+/*
+ * esp_vfs_fat.h
+ *
+ * Host stand-in for the FAT VFS on the SD card. Mounting maps the mount point onto a local
+ * directory. The stdio calls of the translation unit that includes this header are routed
+ * through the simulator, which resolves the path and models the SDSPI transfer cost.
+ */
+
+#ifndef HOST_ESP_VFS_FAT_H_
+#define HOST_ESP_VFS_FAT_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "driver/spi_common.h"
+
+typedef struct
+{
+    bool format_if_mount_failed;
+    int max_files;
+    size_t allocation_unit_size;
+} esp_vfs_fat_sdmmc_mount_config_t;
+
+typedef struct
+{
+    int slot;
+    int max_freq_khz;
+} sdmmc_host_t;
+
+typedef struct
+{
+    uint32_t capacity;
+    int max_freq_khz;
+} sdmmc_card_t;
+
+typedef struct
+{
+    spi_host_device_t host_id;
+    int gpio_cs;
+    int gpio_cd;
+    int gpio_wp;
+    int gpio_int;
+} sdspi_device_config_t;
+
+#define SDMMC_FREQ_DEFAULT          20000
+#define SDSPI_HOST_DEFAULT()        { .slot = SPI2_HOST, .max_freq_khz = SDMMC_FREQ_DEFAULT }
+#define SDSPI_DEVICE_CONFIG_DEFAULT() { .host_id = SPI2_HOST, .gpio_cs = 13, .gpio_cd = -1, .gpio_wp = -1, .gpio_int = -1 }
+
+extern esp_err_t esp_vfs_fat_sdspi_mount(const char *base_path, const sdmmc_host_t *host_config_input,
+                                         const sdspi_device_config_t *slot_config,
+                                         const esp_vfs_fat_sdmmc_mount_config_t *mount_config,
+                                         sdmmc_card_t **out_card);
+
+extern FILE *sim_vfs_fopen(const char *path, const char *mode);
+extern size_t sim_vfs_fread(void *ptr, size_t size, size_t nmemb, FILE *stream);
+extern int sim_vfs_fseek(FILE *stream, long offset, int whence);
+extern int sim_vfs_fclose(FILE *stream);
+
+#define fopen   sim_vfs_fopen
+#define fread   sim_vfs_fread
+#define fseek   sim_vfs_fseek
+#define fclose  sim_vfs_fclose
+
+#endif /* HOST_ESP_VFS_FAT_H_ */
@@ -0,0 +1,54 @@
+/*
+ * FreeRTOS.h
+ *
+ * Host stand-in for the FreeRTOS kernel types. The tick rate matches sdkconfig
+ * (CONFIG_FREERTOS_HZ=100), so tick arithmetic in the application behaves as on the board.
+ */
+
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <stdatomic.h>
+
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define configTICK_RATE_HZ      100
+#define configMAX_PRIORITIES    25
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+
+#define portNUM_PROCESSORS      2
+#define tskIDLE_PRIORITY        ((UBaseType_t)0U)
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define errQUEUE_FULL           ((BaseType_t)0)
+
+/* Critical sections are a spinlock between the threads. Interrupt handlers are threads as well,
+ * so the ISR variants are the same. */
+typedef struct
+{
+    atomic_flag locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { ATOMIC_FLAG_INIT }
+#define portENTER_CRITICAL(mux)         do { while (atomic_flag_test_and_set(&(mux)->locked)) { } } while (0)
+#define portEXIT_CRITICAL(mux)          atomic_flag_clear(&(mux)->locked)
+#define portENTER_CRITICAL_ISR(mux)     portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)      portEXIT_CRITICAL(mux)
+#define portYIELD_FROM_ISR(woken)       ((void)(woken))
+
+#endif /* HOST_FREERTOS_H_ */
@@ -0,0 +1,21 @@
+/*
+ * queue.h
+ *
+ * Host stand-in for FreeRTOS queues. Items are copied in and out as on the board, and a
+ * blocking receive waits on the simulated clock like any other task wait.
+ */
+
+#ifndef HOST_FREERTOS_QUEUE_H_
+#define HOST_FREERTOS_QUEUE_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_queue_t * QueueHandle_t;
+
+extern QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize);
+extern BaseType_t xQueueSend(QueueHandle_t xQueue, const void * pvItemToQueue, TickType_t xTicksToWait);
+extern BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void * pvItemToQueue, BaseType_t * pxHigherPriorityTaskWoken);
+extern BaseType_t xQueueReceive(QueueHandle_t xQueue, void * pvBuffer, TickType_t xTicksToWait);
+extern UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue);
+
+#endif /* HOST_FREERTOS_QUEUE_H_ */
@@ -0,0 +1,19 @@
+/*
+ * semphr.h
+ *
+ * Host stand-in for FreeRTOS binary semaphores. As in FreeRTOS they are queues of one item
+ * with no data.
+ */
+
+#ifndef HOST_FREERTOS_SEMPHR_H_
+#define HOST_FREERTOS_SEMPHR_H_
+
+#include "freertos/queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+#define xSemaphoreCreateBinary()            xQueueCreate(1u, 0u)
+#define xSemaphoreTake(xSemaphore, xBlock)  xQueueReceive((xSemaphore), NULL, (xBlock))
+#define xSemaphoreGive(xSemaphore)          xQueueSend((xSemaphore), NULL, 0u)
+
+#endif /* HOST_FREERTOS_SEMPHR_H_ */
@@ -0,0 +1,28 @@
+/*
+ * task.h
+ *
+ * Host stand-in for the FreeRTOS task API. Every task is a thread, delays and blocking
+ * waits run on the simulated clock instead of sleeping.
+ */
+
+#ifndef HOST_FREERTOS_TASK_H_
+#define HOST_FREERTOS_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_task_t * TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+extern TickType_t xTaskGetTickCount(void);
+extern void vTaskDelay(const TickType_t xTicksToDelay);
+extern void vTaskDelayUntil(TickType_t * const pxPreviousWakeTime, const TickType_t xTimeIncrement);
+
+extern BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char * const pcName, const uint32_t usStackDepth,
+                                          void * const pvParameters, UBaseType_t uxPriority,
+                                          TaskHandle_t * const pxCreatedTask, const BaseType_t xCoreID);
+extern void vTaskDelete(TaskHandle_t xTaskToDelete);
+
+extern uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+extern BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+
+#endif /* HOST_FREERTOS_TASK_H_ */
@@ -0,0 +1,106 @@
+/*
+ * sim.h
+ *
+ * Internal interface of the host simulator: simulated clock, board wiring, the ST7789
+ * panel model and the statistics gathered while the application runs.
+ */
+
+#ifndef HOST_SIM_H_
+#define HOST_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Board wiring, mirrors the pin assignments in main.c and display.c. */
+#define SIM_LCD_PIN_DC          7
+#define SIM_JOY_X_CHANNEL       2       /* ADC_CHANNEL_2 of ADC unit 1 */
+#define SIM_JOY_Y_CHANNEL       7       /* ADC_CHANNEL_7 of ADC unit 1 */
+#define SIM_JOY_BTN_GPIO        18
+
+#define SIM_PANEL_WIDTH         320u
+#define SIM_PANEL_HEIGHT        240u
+
+#define SIM_SD_SECTOR_SIZE      512u
+
+#define SIM_MAX(a,b)            ((a) > (b) ? (a) : (b))
+
+typedef struct
+{
+    /* Frames are counted at every blocking ulTaskNotifyTake(), i.e. once per snapshot the render task
+     * waits for. Frame CPU time is the render task's own thread time. */
+    uint64_t frames;
+    uint64_t frame_cpu_ns_total;
+    uint64_t frame_cpu_ns_max;
+    uint64_t frame_spi_bytes_max;
+    uint64_t frame_sim_us_max;
+
+    uint64_t spi_transactions;
+    uint64_t spi_bytes;
+    uint64_t spi_pixel_bytes;
+    uint64_t spi_ramwr_count;
+    uint64_t spi_bus_us;
+
+    uint64_t sd_files_opened;
+    uint64_t sd_open_failures;
+    uint64_t sd_bytes_read;
+    uint64_t sd_seeks;
+    uint64_t sd_sectors_read;
+    uint64_t sd_bus_us;
+
+    uint64_t heap_allocs;
+    uint64_t heap_frees;
+    uint64_t heap_failed_allocs;
+    size_t heap_internal_used;
+    size_t heap_internal_peak;
+    size_t heap_spiram_used;
+    size_t heap_spiram_peak;
+} sim_stats_t;
+
+extern sim_stats_t sim_stats;
+
+/* Simulated clock, microseconds since boot. Waiting blocks the calling task until the clock gets
+ * there, which happens once every other task is blocked as well. */
+extern int64_t sim_now_us(void);
+extern void sim_wait_until_us(int64_t t_us);
+
+/* Called by the FreeRTOS stand-in around every ulTaskNotifyTake(), with the scheduler locked. */
+extern void sim_frame_end(void);
+extern void sim_frame_begin(void);
+
+/* End of the run: the scheduler calls sim_finish() once the clock reaches sim_end_us(), or when no
+ * task can run any more. It prints the report and exits. */
+extern int64_t sim_end_us(void);
+extern void sim_finish(void) __attribute__((noreturn));
+/* Moves the end of the run, for programs that run until they are done rather than for a duration. */
+extern void sim_set_end_us(int64_t t_us);
+
+/* Reserves the shared SPI bus for duration_us. Returns the completion time. */
+extern int64_t sim_spi_bus_reserve(int host, int64_t duration_us);
+
+/* Panel model */
+extern void sim_panel_reset(void);
+extern void sim_panel_command(uint8_t cmd);
+extern void sim_panel_data(const uint8_t *data, size_t len);
+extern const uint16_t *sim_panel_pixels(void);
+extern uint32_t sim_panel_checksum(void);
+extern bool sim_panel_write_ppm(const char *path);
+
+/* Joystick script */
+extern bool sim_input_load(const char *path);
+extern int64_t sim_input_last_event_ms(void);
+extern int sim_input_adc_raw(int channel, int64_t t_us);
+
+/* GPIO levels recorded from gpio_set_level() */
+extern uint32_t sim_gpio_output_level(int gpio_num);
+
+/* Heap limits */
+extern void sim_heap_set_internal_limit(size_t bytes);
+
+/* SD card root on the host file system */
+extern void sim_sdcard_set_root(const char *dir);
+extern const char *sim_sdcard_get_root(void);
+
+extern bool sim_log_enabled;
+
+#endif /* HOST_SIM_H_ */
@@ -0,0 +1,159 @@
+/*
+ * sim_adc.c
+ *
+ * Continuous mode ADC stand-in. The conversions of the configured pattern run back to back at
+ * sample_freq_hz from adc_continuous_start(), each one sampling the joystick script at its own
+ * time. adc_continuous_read() hands out whole conversion frames and blocks until the next one
+ * is complete, like the driver waiting for its DMA. If the reader falls further behind than the
+ * store buffer holds, the oldest frames are lost, as on the board.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_adc/adc_continuous.h"
+
+#include "sim.h"
+
+#define SIM_ADC_MAX_PATTERN     8
+
+struct adc_continuous_ctx_t
+{
+    adc_continuous_handle_cfg_t cfg;
+    adc_digi_pattern_config_t pattern[SIM_ADC_MAX_PATTERN];
+    uint32_t pattern_num;
+    uint32_t sample_freq_hz;
+    bool configured;
+    bool running;
+    int64_t start_us;
+    uint64_t next_frame;            /* Index of the next frame to hand out */
+};
+
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t * hdl_config, adc_continuous_handle_t * ret_handle)
+{
+    struct adc_continuous_ctx_t *ctx;
+
+    if ((hdl_config->conv_frame_size == 0u) || ((hdl_config->conv_frame_size % SOC_ADC_DIGI_RESULT_BYTES) != 0u) ||
+        (hdl_config->max_store_buf_size < hdl_config->conv_frame_size))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ctx = calloc(1, sizeof(*ctx));
+    ctx->cfg = *hdl_config;
+    *ret_handle = ctx;
+
+    return ESP_OK;
+}
+
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t * config)
+{
+    if (handle->running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if ((config->pattern_num == 0u) || (config->pattern_num > SIM_ADC_MAX_PATTERN) ||
+        (config->sample_freq_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW) || (config->sample_freq_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH) ||
+        (config->format != ADC_DIGI_OUTPUT_FORMAT_TYPE2))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(handle->pattern, config->adc_pattern, config->pattern_num * sizeof(adc_digi_pattern_config_t));
+    handle->pattern_num = config->pattern_num;
+    handle->sample_freq_hz = config->sample_freq_hz;
+    handle->configured = true;
+
+    return ESP_OK;
+}
+
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle)
+{
+    if (!handle->configured || handle->running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    handle->running = true;
+    handle->start_us = sim_now_us();
+    handle->next_frame = 0u;
+
+    return ESP_OK;
+}
+
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle)
+{
+    if (!handle->running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    handle->running = false;
+    return ESP_OK;
+}
+
+
+/* Time of conversion number sample since the start. */
+static int64_t sample_time_us(adc_continuous_handle_t handle, uint64_t sample)
+{
+    return handle->start_us + (int64_t)((sample * 1000000u) / handle->sample_freq_hz);
+}
+
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t * buf, uint32_t length_max,
+                              uint32_t * out_length, uint32_t timeout_ms)
+{
+    uint32_t frame_samples = handle->cfg.conv_frame_size / SOC_ADC_DIGI_RESULT_BYTES;
+    uint64_t stored_frames = handle->cfg.max_store_buf_size / handle->cfg.conv_frame_size;
+    uint64_t completed;
+    uint64_t first_sample;
+    int64_t ready_us;
+
+    *out_length = 0u;
+
+    if (!handle->running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Frames that completed while nobody read them pile up until the store buffer is full. */
+    completed = (uint64_t)(((sim_now_us() - handle->start_us) * (int64_t)handle->sample_freq_hz) / 1000000) / frame_samples;
+    if (completed > (handle->next_frame + stored_frames))
+    {
+        handle->next_frame = completed - stored_frames;
+    }
+
+    first_sample = handle->next_frame * frame_samples;
+    ready_us = sample_time_us(handle, first_sample + frame_samples);
+
+    if (ready_us > sim_now_us())
+    {
+        if ((timeout_ms != ADC_MAX_DELAY) && (ready_us > sim_now_us() + (int64_t)timeout_ms * 1000))
+        {
+            sim_wait_until_us(sim_now_us() + (int64_t)timeout_ms * 1000);
+            return ESP_ERR_TIMEOUT;
+        }
+        sim_wait_until_us(ready_us);
+    }
+
+    for (uint32_t ix = 0u; (ix < frame_samples) && (((ix + 1u) * SOC_ADC_DIGI_RESULT_BYTES) <= length_max); ix++)
+    {
+        uint64_t sample = first_sample + ix;
+        const adc_digi_pattern_config_t *pattern = &handle->pattern[sample % handle->pattern_num];
+        adc_digi_output_data_t result = { .val = 0u };
+
+        result.type2.data = (uint32_t)sim_input_adc_raw(pattern->channel, sample_time_us(handle, sample)) & 0xfffu;
+        result.type2.channel = pattern->channel;
+        result.type2.unit = pattern->unit;
+        memcpy(&buf[ix * SOC_ADC_DIGI_RESULT_BYTES], &result, sizeof(result));
+        *out_length += SOC_ADC_DIGI_RESULT_BYTES;
+    }
+
+    handle->next_frame++;
+    return ESP_OK;
+}
@@ -0,0 +1,457 @@
+/*
+ * sim_freertos.c
+ *
+ * FreeRTOS task and queue API on top of the simulated clock. Every task is a thread and they
+ * run truly in parallel, but the clock only moves when all of them are blocked: it then jumps
+ * to the earliest wake up time and releases the task waiting for it. Tasks due at the same time
+ * are released one after the other, highest priority first, like a single core would run them.
+ * A task woken by a notification or a queue runs alongside the one that woke it. Computation
+ * takes no simulated time, waiting does, so a run is repeatable however the host schedules the
+ * threads.
+ *
+ * The thread that calls app_main() is the first task. Like on the board, it ends when
+ * app_main() returns, and the run ends once every task is blocked past the requested duration.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+
+#include "sim.h"
+
+#define SIM_MAX_TASKS       8
+#define SIM_NEVER_US        INT64_MAX
+
+struct sim_task_t
+{
+    pthread_t thread;
+    const char *name;
+    TaskFunction_t code;
+    void *param;
+    UBaseType_t priority;
+    pthread_cond_t wake;
+    bool blocked;
+    const void *wait_object;    /* The task itself for a notification, a queue, or NULL */
+    int64_t wake_us;            /* SIM_NEVER_US if only wait_object ends the wait */
+    uint32_t notify_count;
+    bool in_frame;
+};
+
+struct sim_queue_t
+{
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+static struct sim_task_t priv_tasks[SIM_MAX_TASKS];
+static int priv_task_count;
+static int priv_running_count;  /* Tasks that are not blocked */
+static pthread_mutex_t priv_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Atomic int64_t priv_now_us = 0;
+static _Thread_local struct sim_task_t *priv_current;
+
+
+int64_t sim_now_us(void)
+{
+    return atomic_load(&priv_now_us);
+}
+
+
+int64_t esp_timer_get_time(void)
+{
+    return atomic_load(&priv_now_us);
+}
+
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(sim_now_us() / (portTICK_PERIOD_MS * 1000));
+}
+
+
+/* Must hold priv_lock. The first thread to use the API becomes a task here. */
+static struct sim_task_t *current_task(void)
+{
+    if (priv_current == NULL)
+    {
+        if (priv_task_count == SIM_MAX_TASKS)
+        {
+            fprintf(stderr, "sim: more than %d tasks\n", SIM_MAX_TASKS);
+            abort();
+        }
+
+        priv_current = &priv_tasks[priv_task_count++];
+        priv_current->name = "main";
+        priv_current->priority = 1u;
+        priv_current->thread = pthread_self();
+        pthread_cond_init(&priv_current->wake, NULL);
+        priv_running_count++;
+    }
+
+    return priv_current;
+}
+
+
+/* Must hold priv_lock. */
+static void unblock(struct sim_task_t *task)
+{
+    task->blocked = false;
+    task->wait_object = NULL;
+    priv_running_count++;
+    pthread_cond_signal(&task->wake);
+}
+
+
+/* Must hold priv_lock. Wakes every task waiting for the object, they check again for themselves. */
+static void unblock_waiters(const void *object)
+{
+    for (int ix = 0; ix < priv_task_count; ix++)
+    {
+        if (priv_tasks[ix].blocked && (priv_tasks[ix].wait_object == object))
+        {
+            unblock(&priv_tasks[ix]);
+        }
+    }
+}
+
+
+/* Must hold priv_lock, with every task blocked. Moves the clock to the next wake up and releases
+ * the task that is due. */
+static void advance_clock(void)
+{
+    struct sim_task_t *next = NULL;
+    int64_t next_us = SIM_NEVER_US;
+
+    for (int ix = 0; ix < priv_task_count; ix++)
+    {
+        struct sim_task_t *task = &priv_tasks[ix];
+
+        if (task->blocked && ((task->wake_us < next_us) ||
+                              ((task->wake_us == next_us) && (next != NULL) && (task->priority > next->priority))))
+        {
+            next = task;
+            next_us = task->wake_us;
+        }
+    }
+
+    if (next_us == SIM_NEVER_US)
+    {
+        /* Either every task has ended, or the rest wait for notifications nobody can send. */
+        for (int ix = 0; ix < priv_task_count; ix++)
+        {
+            if (priv_tasks[ix].blocked)
+            {
+                fprintf(stderr, "sim: every task is blocked forever\n");
+                break;
+            }
+        }
+        sim_finish();
+    }
+
+    if (next_us > sim_now_us())
+    {
+        atomic_store(&priv_now_us, next_us);
+    }
+
+    if (sim_now_us() >= sim_end_us())
+    {
+        sim_finish();
+    }
+
+    unblock(next);
+}
+
+
+/* Must hold priv_lock. Returns when the clock reaches wake_us, or when something happens to
+ * wait_object if it is not NULL. */
+static void block(struct sim_task_t *task, int64_t wake_us, const void *wait_object)
+{
+    task->blocked = true;
+    task->wait_object = wait_object;
+    task->wake_us = wake_us;
+    priv_running_count--;
+
+    if (priv_running_count == 0)
+    {
+        advance_clock();
+    }
+
+    while (task->blocked)
+    {
+        pthread_cond_wait(&task->wake, &priv_lock);
+    }
+}
+
+
+/* Must hold priv_lock. The deadline of a wait of the given number of ticks. */
+static int64_t deadline_us(TickType_t ticks)
+{
+    return (ticks == portMAX_DELAY) ? SIM_NEVER_US : sim_now_us() + ((int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+
+void sim_wait_until_us(int64_t t_us)
+{
+    pthread_mutex_lock(&priv_lock);
+
+    if (t_us > sim_now_us())
+    {
+        block(current_task(), t_us, NULL);
+    }
+
+    pthread_mutex_unlock(&priv_lock);
+}
+
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    /* A delay always lasts until the next tick boundary at least, like on the device. */
+    int64_t wake_tick = (int64_t)xTaskGetTickCount() + (xTicksToDelay > 0 ? xTicksToDelay : 1);
+    sim_wait_until_us(wake_tick * portTICK_PERIOD_MS * 1000);
+}
+
+
+void vTaskDelayUntil(TickType_t * const pxPreviousWakeTime, const TickType_t xTimeIncrement)
+{
+    TickType_t wake = *pxPreviousWakeTime + xTimeIncrement;
+
+    /* If the deadline already passed the task is not blocked, exactly as in FreeRTOS. */
+    if ((int32_t)(wake - xTaskGetTickCount()) > 0)
+    {
+        sim_wait_until_us((int64_t)wake * portTICK_PERIOD_MS * 1000);
+    }
+
+    *pxPreviousWakeTime = wake;
+}
+
+
+static void *task_entry(void *arg)
+{
+    struct sim_task_t *task = arg;
+
+    priv_current = task;
+    task->code(task->param);
+
+    /* A FreeRTOS task must not return, treat it as deleting itself. */
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char * const pcName, const uint32_t usStackDepth,
+                                   void * const pvParameters, UBaseType_t uxPriority,
+                                   TaskHandle_t * const pxCreatedTask, const BaseType_t xCoreID)
+{
+    struct sim_task_t *task;
+
+    /* Priorities only order tasks that are due at the same time, the threads run wherever the OS puts them. */
+    (void)usStackDepth;
+    (void)xCoreID;
+
+    pthread_mutex_lock(&priv_lock);
+    current_task();
+
+    if (priv_task_count == SIM_MAX_TASKS)
+    {
+        pthread_mutex_unlock(&priv_lock);
+        return pdFAIL;
+    }
+
+    task = &priv_tasks[priv_task_count++];
+    task->name = pcName;
+    task->code = pxTaskCode;
+    task->param = pvParameters;
+    task->priority = uxPriority;
+    pthread_cond_init(&task->wake, NULL);
+    priv_running_count++;
+
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0)
+    {
+        fprintf(stderr, "sim: cannot start task %s\n", pcName);
+        abort();
+    }
+
+    pthread_mutex_unlock(&priv_lock);
+
+    if (pxCreatedTask != NULL)
+    {
+        *pxCreatedTask = task;
+    }
+
+    return pdPASS;
+}
+
+
+/* Only a task deleting itself is supported. Does not return. */
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    struct sim_task_t *task;
+
+    pthread_mutex_lock(&priv_lock);
+    task = current_task();
+
+    if ((xTaskToDelete != NULL) && (xTaskToDelete != task))
+    {
+        fprintf(stderr, "sim: vTaskDelete() of another task is not supported\n");
+        abort();
+    }
+
+    priv_running_count--;
+
+    if (priv_running_count == 0)
+    {
+        advance_clock();
+    }
+
+    pthread_mutex_unlock(&priv_lock);
+    pthread_exit(NULL);
+}
+
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    struct sim_task_t *task;
+    uint32_t count;
+
+    pthread_mutex_lock(&priv_lock);
+    task = current_task();
+
+    if (task->in_frame)
+    {
+        sim_frame_end();
+    }
+
+    if ((task->notify_count == 0u) && (xTicksToWait > 0u))
+    {
+        block(task, deadline_us(xTicksToWait), task);
+    }
+
+    count = task->notify_count;
+    if (count > 0u)
+    {
+        task->notify_count = xClearCountOnExit ? 0u : (count - 1u);
+    }
+
+    sim_frame_begin();
+    task->in_frame = true;
+
+    pthread_mutex_unlock(&priv_lock);
+    return count;
+}
+
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    pthread_mutex_lock(&priv_lock);
+
+    xTaskToNotify->notify_count++;
+    unblock_waiters(xTaskToNotify);
+
+    pthread_mutex_unlock(&priv_lock);
+    return pdPASS;
+}
+
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+    struct sim_queue_t *queue = calloc(1, sizeof(*queue));
+
+    queue->items = calloc(uxQueueLength, uxItemSize);
+    queue->length = uxQueueLength;
+    queue->item_size = uxItemSize;
+
+    return queue;
+}
+
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void * pvItemToQueue, TickType_t xTicksToWait)
+{
+    int64_t deadline;
+
+    pthread_mutex_lock(&priv_lock);
+    deadline = deadline_us(xTicksToWait);
+
+    while (xQueue->count == xQueue->length)
+    {
+        if (sim_now_us() >= deadline)
+        {
+            pthread_mutex_unlock(&priv_lock);
+            return errQUEUE_FULL;
+        }
+        block(current_task(), deadline, xQueue);
+    }
+
+    /* Semaphores are queues of empty items, see semphr.h */
+    if (xQueue->item_size > 0u)
+    {
+        memcpy(&xQueue->items[((xQueue->head + xQueue->count) % xQueue->length) * xQueue->item_size],
+               pvItemToQueue, xQueue->item_size);
+    }
+    xQueue->count++;
+    unblock_waiters(xQueue);
+
+    pthread_mutex_unlock(&priv_lock);
+    return pdPASS;
+}
+
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void * pvItemToQueue, BaseType_t * pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL)
+    {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+
+    return xQueueSend(xQueue, pvItemToQueue, 0u);
+}
+
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void * pvBuffer, TickType_t xTicksToWait)
+{
+    int64_t deadline;
+
+    pthread_mutex_lock(&priv_lock);
+    deadline = deadline_us(xTicksToWait);
+
+    while (xQueue->count == 0u)
+    {
+        if (sim_now_us() >= deadline)
+        {
+            pthread_mutex_unlock(&priv_lock);
+            return pdFALSE;
+        }
+        block(current_task(), deadline, xQueue);
+    }
+
+    if (xQueue->item_size > 0u)
+    {
+        memcpy(pvBuffer, &xQueue->items[xQueue->head * xQueue->item_size], xQueue->item_size);
+    }
+    xQueue->head = (xQueue->head + 1u) % xQueue->length;
+    xQueue->count--;
+    unblock_waiters(xQueue);
+
+    pthread_mutex_unlock(&priv_lock);
+    return pdPASS;
+}
+
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue)
+{
+    UBaseType_t count;
+
+    pthread_mutex_lock(&priv_lock);
+    count = xQueue->count;
+    pthread_mutex_unlock(&priv_lock);
+
+    return count;
+}
@@ -0,0 +1,158 @@
+/*
+ * sim_heap.c
+ *
+ * Capability heap stand-in. Internal (DMA-capable) RAM has a hard limit like on the board,
+ * so leaks end in the same failed allocation instead of growing forever on the host.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+
+#include "sim.h"
+
+/* What is left of the S3's internal SRAM for the application heap with this sdkconfig. */
+#define SIM_DEFAULT_INTERNAL_HEAP_BYTES     (300u * 1024u)
+#define SIM_SPIRAM_HEAP_BYTES               (8u * 1024u * 1024u)
+
+typedef struct
+{
+    size_t size;
+    uint32_t caps;
+    uint64_t pad;   /* keeps the user block 16 byte aligned */
+} sim_block_t;
+
+static size_t priv_internal_limit = SIM_DEFAULT_INTERNAL_HEAP_BYTES;
+static size_t priv_internal_min_free = SIM_DEFAULT_INTERNAL_HEAP_BYTES;
+
+
+void sim_heap_set_internal_limit(size_t bytes)
+{
+    priv_internal_limit = bytes;
+    priv_internal_min_free = bytes;
+}
+
+
+static bool is_spiram(uint32_t caps)
+{
+    return (caps & MALLOC_CAP_SPIRAM) != 0u;
+}
+
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    sim_block_t *blk;
+
+    if (is_spiram(caps))
+    {
+        if ((sim_stats.heap_spiram_used + size) > SIM_SPIRAM_HEAP_BYTES)
+        {
+            sim_stats.heap_failed_allocs++;
+            return NULL;
+        }
+    }
+    else if ((sim_stats.heap_internal_used + size) > priv_internal_limit)
+    {
+        sim_stats.heap_failed_allocs++;
+        return NULL;
+    }
+
+    blk = malloc(sizeof(sim_block_t) + size);
+    if (blk == NULL)
+    {
+        sim_stats.heap_failed_allocs++;
+        return NULL;
+    }
+
+    blk->size = size;
+    blk->caps = caps;
+    sim_stats.heap_allocs++;
+
+    if (is_spiram(caps))
+    {
+        sim_stats.heap_spiram_used += size;
+        sim_stats.heap_spiram_peak = SIM_MAX(sim_stats.heap_spiram_peak, sim_stats.heap_spiram_used);
+    }
+    else
+    {
+        sim_stats.heap_internal_used += size;
+        sim_stats.heap_internal_peak = SIM_MAX(sim_stats.heap_internal_peak, sim_stats.heap_internal_used);
+        if ((priv_internal_limit - sim_stats.heap_internal_used) < priv_internal_min_free)
+        {
+            priv_internal_min_free = priv_internal_limit - sim_stats.heap_internal_used;
+        }
+    }
+
+    return blk + 1;
+}
+
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    void *p = heap_caps_malloc(n * size, caps);
+
+    if (p != NULL)
+    {
+        memset(p, 0, n * size);
+    }
+
+    return p;
+}
+
+
+void heap_caps_free(void *ptr)
+{
+    sim_block_t *blk;
+
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+    blk = (sim_block_t *)ptr - 1;
+
+    if (is_spiram(blk->caps))
+    {
+        sim_stats.heap_spiram_used -= blk->size;
+    }
+    else
+    {
+        sim_stats.heap_internal_used -= blk->size;
+    }
+
+    sim_stats.heap_frees++;
+    free(blk);
+}
+
+
+size_t heap_caps_get_total_size(uint32_t caps)
+{
+    if (is_spiram(caps))
+    {
+        return SIM_SPIRAM_HEAP_BYTES;
+    }
+    else if (caps & (MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL))
+    {
+        return priv_internal_limit;
+    }
+
+    return priv_internal_limit + SIM_SPIRAM_HEAP_BYTES;
+}
+
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    if (is_spiram(caps))
+    {
+        return SIM_SPIRAM_HEAP_BYTES - sim_stats.heap_spiram_used;
+    }
+
+    return priv_internal_limit - sim_stats.heap_internal_used;
+}
+
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    (void)caps;
+    return priv_internal_min_free;
+}
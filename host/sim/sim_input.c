@@ -0,0 +1,244 @@
+/*
+ * sim_input.c
+ *
+ * GPIO stand-in and the joystick script. Joystick readings are replayed from a script with one
+ * event per line:
+ *
+ *     <time_ms> <x_raw> <y_raw> <button_level>
+ *
+ * Each event holds until the next one. Lines starting with '#' are comments. Without a script
+ * the stick rests in the centre and the (active low) button is released. A button interrupt
+ * handler is called from its own task at every change of the button level in the script, so
+ * contact bounce can be scripted as a burst of short events.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+
+#include "sim.h"
+
+#define SIM_JOY_CENTRE  2048
+
+typedef struct
+{
+    int64_t t_ms;
+    int x;
+    int y;
+    int btn;
+} sim_input_event_t;
+
+static sim_input_event_t *priv_events;
+static size_t priv_event_count;
+static uint32_t priv_gpio_out[GPIO_NUM_MAX];
+static bool priv_isr_service_installed;
+static gpio_isr_t priv_button_isr;
+static void *priv_button_isr_arg;
+
+
+bool sim_input_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    size_t capacity = 0u;
+
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        sim_input_event_t ev;
+        long long t;
+
+        if ((line[0] == '#') || (sscanf(line, "%lld %d %d %d", &t, &ev.x, &ev.y, &ev.btn) != 4))
+        {
+            continue;
+        }
+
+        ev.t_ms = t;
+
+        if (priv_event_count == capacity)
+        {
+            capacity = (capacity == 0u) ? 64u : capacity * 2u;
+            priv_events = realloc(priv_events, capacity * sizeof(*priv_events));
+        }
+
+        priv_events[priv_event_count++] = ev;
+    }
+
+    fclose(f);
+    return true;
+}
+
+
+int64_t sim_input_last_event_ms(void)
+{
+    return (priv_event_count > 0u) ? priv_events[priv_event_count - 1u].t_ms : 0;
+}
+
+
+/* The event in effect at t_us, or NULL before the first one. */
+static const sim_input_event_t *event_at(int64_t t_us)
+{
+    int64_t t_ms = t_us / 1000;
+    size_t low = 0u;
+    size_t high = priv_event_count;
+
+    /* Find the first event after t_ms, the one before it is in effect. */
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2u;
+
+        if (priv_events[mid].t_ms <= t_ms)
+        {
+            low = mid + 1u;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return (low > 0u) ? &priv_events[low - 1u] : NULL;
+}
+
+
+int sim_input_adc_raw(int channel, int64_t t_us)
+{
+    const sim_input_event_t *ev = event_at(t_us);
+
+    if (ev == NULL)
+    {
+        return SIM_JOY_CENTRE;
+    }
+
+    if (channel == SIM_JOY_X_CHANNEL)
+    {
+        return ev->x;
+    }
+    else if (channel == SIM_JOY_Y_CHANNEL)
+    {
+        return ev->y;
+    }
+
+    return 0;
+}
+
+
+/* Time of the first change of the button level after t_us, or -1 if there is none. */
+static int64_t next_button_edge_us(int64_t t_us)
+{
+    const sim_input_event_t *ev = event_at(t_us);
+    int level = (ev != NULL) ? ev->btn : 1;
+    size_t ix = (ev != NULL) ? (size_t)(ev - priv_events) + 1u : 0u;
+
+    for (; ix < priv_event_count; ix++)
+    {
+        if (priv_events[ix].btn != level)
+        {
+            return priv_events[ix].t_ms * 1000;
+        }
+    }
+
+    return -1;
+}
+
+
+/* Stands in for the GPIO interrupt: calls the handler at every edge, then ends. */
+static void button_interrupt_task(void *param)
+{
+    int64_t edge_us;
+
+    (void)param;
+
+    while ((edge_us = next_button_edge_us(sim_now_us())) >= 0)
+    {
+        sim_wait_until_us(edge_us);
+        priv_button_isr(priv_button_isr_arg);
+    }
+
+    vTaskDelete(NULL);
+}
+
+
+esp_err_t gpio_config(const gpio_config_t *pGPIOConfig)
+{
+    (void)pGPIOConfig;
+    return ESP_OK;
+}
+
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if ((gpio_num < 0) || (gpio_num >= GPIO_NUM_MAX))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    priv_gpio_out[gpio_num] = level;
+    return ESP_OK;
+}
+
+
+uint32_t sim_gpio_output_level(int gpio_num)
+{
+    return priv_gpio_out[gpio_num];
+}
+
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    const sim_input_event_t *ev;
+
+    if (gpio_num != SIM_JOY_BTN_GPIO)
+    {
+        return (int)priv_gpio_out[gpio_num];
+    }
+
+    ev = event_at(sim_now_us());
+    return (ev != NULL) ? ev->btn : 1;
+}
+
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    (void)intr_alloc_flags;
+
+    if (priv_isr_service_installed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    priv_isr_service_installed = true;
+    return ESP_OK;
+}
+
+
+/* Only the joystick button has edges to report. */
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+    if (!priv_isr_service_installed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (gpio_num != SIM_JOY_BTN_GPIO)
+    {
+        return ESP_OK;
+    }
+
+    priv_button_isr = isr_handler;
+    priv_button_isr_arg = args;
+
+    if (xTaskCreatePinnedToCore(button_interrupt_task, "gpio_isr", 2048u, NULL, configMAX_PRIORITIES, NULL, 0) != pdPASS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
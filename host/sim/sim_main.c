@@ -0,0 +1,264 @@
+/*
+ * sim_main.c
+ *
+ * Host entry point. Sets up the simulated board and runs app_main() and the tasks it starts
+ * until the simulated clock reaches the requested duration, then prints the run statistics.
+ *
+ *     enginaator_sim [--sdcard DIR] [--input SCRIPT] [--duration-ms N] [--dma-heap-kb N]
+ *                    [--ppm FILE] [--quiet]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/task.h"
+
+#include "sim.h"
+
+extern void app_main(void);
+
+sim_stats_t sim_stats;
+bool sim_log_enabled = true;
+
+static int64_t priv_duration_us = 10 * 1000 * 1000;
+static const char *priv_ppm_path = NULL;
+static uint64_t priv_frame_start_ns;
+static uint64_t priv_frame_start_spi_bytes;
+static int64_t priv_frame_start_sim_us;
+static int priv_stdin_flags = -1;
+
+
+/* CPU time of the calling thread, so time spent blocked in the other tasks does not count. */
+static uint64_t thread_cpu_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+
+void sim_log(char level, const char *tag, const char *format, ...)
+{
+    va_list args;
+
+    if (!sim_log_enabled)
+    {
+        return;
+    }
+
+    printf("%c (%" PRId64 ") %s: ", level, sim_now_us() / 1000, tag);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
+
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+        case ESP_OK:                return "ESP_OK";
+        case ESP_FAIL:              return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:  return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+        default:                    return "UNKNOWN ERROR";
+    }
+}
+
+
+static void print_report(void)
+{
+    uint64_t frames = (sim_stats.frames > 0u) ? sim_stats.frames : 1u;
+
+    fprintf(stderr, "\n==== simulation report ====\n");
+    fprintf(stderr, "sim time            : %" PRId64 " ms\n", sim_now_us() / 1000);
+    fprintf(stderr, "frames              : %" PRIu64 "\n", sim_stats.frames);
+    fprintf(stderr, "frame cpu (host)    : avg %" PRIu64 " us, max %" PRIu64 " us\n",
+            sim_stats.frame_cpu_ns_total / frames / 1000u, sim_stats.frame_cpu_ns_max / 1000u);
+    fprintf(stderr, "frame time (sim)    : max %" PRIu64 " us\n", sim_stats.frame_sim_us_max);
+    fprintf(stderr, "spi transactions    : %" PRIu64 "\n", sim_stats.spi_transactions);
+    fprintf(stderr, "spi bytes           : %" PRIu64 " (pixels %" PRIu64 ", %" PRIu64 " RAMWR)\n",
+            sim_stats.spi_bytes, sim_stats.spi_pixel_bytes, sim_stats.spi_ramwr_count);
+    fprintf(stderr, "spi bytes / frame   : avg %" PRIu64 ", max %" PRIu64 "\n",
+            sim_stats.spi_bytes / frames, sim_stats.frame_spi_bytes_max);
+    fprintf(stderr, "spi bus busy        : %" PRIu64 " ms\n", sim_stats.spi_bus_us / 1000u);
+    fprintf(stderr, "sd files opened     : %" PRIu64 " (%" PRIu64 " failed)\n",
+            sim_stats.sd_files_opened, sim_stats.sd_open_failures);
+    fprintf(stderr, "sd bytes read       : %" PRIu64 " (%" PRIu64 " sectors, %" PRIu64 " seeks)\n",
+            sim_stats.sd_bytes_read, sim_stats.sd_sectors_read, sim_stats.sd_seeks);
+    fprintf(stderr, "sd bus time         : %" PRIu64 " ms\n", sim_stats.sd_bus_us / 1000u);
+    fprintf(stderr, "heap internal       : %zu bytes in use, peak %zu\n",
+            sim_stats.heap_internal_used, sim_stats.heap_internal_peak);
+    fprintf(stderr, "heap spiram         : %zu bytes in use, peak %zu\n",
+            sim_stats.heap_spiram_used, sim_stats.heap_spiram_peak);
+    fprintf(stderr, "heap allocs / frees : %" PRIu64 " / %" PRIu64 " (%" PRIu64 " failed)\n",
+            sim_stats.heap_allocs, sim_stats.heap_frees, sim_stats.heap_failed_allocs);
+    fprintf(stderr, "panel checksum      : %08" PRIx32 "\n", sim_panel_checksum());
+}
+
+
+int64_t sim_end_us(void)
+{
+    return priv_duration_us;
+}
+
+
+void sim_set_end_us(int64_t t_us)
+{
+    priv_duration_us = t_us;
+}
+
+
+void sim_finish(void)
+{
+    /* Keep the report after the application output when both go to the same place. */
+    fflush(stdout);
+    print_report();
+
+    if ((priv_ppm_path != NULL) && !sim_panel_write_ppm(priv_ppm_path))
+    {
+        fprintf(stderr, "sim: could not write %s\n", priv_ppm_path);
+    }
+
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+
+void sim_frame_end(void)
+{
+    uint64_t now_ns = thread_cpu_time_ns();
+    uint64_t cpu_ns = now_ns - priv_frame_start_ns;
+    uint64_t spi_bytes = sim_stats.spi_bytes - priv_frame_start_spi_bytes;
+    uint64_t sim_us = (uint64_t)(sim_now_us() - priv_frame_start_sim_us);
+
+    sim_stats.frames++;
+    sim_stats.frame_cpu_ns_total += cpu_ns;
+    sim_stats.frame_cpu_ns_max = SIM_MAX(sim_stats.frame_cpu_ns_max, cpu_ns);
+    sim_stats.frame_spi_bytes_max = SIM_MAX(sim_stats.frame_spi_bytes_max, spi_bytes);
+    sim_stats.frame_sim_us_max = SIM_MAX(sim_stats.frame_sim_us_max, sim_us);
+}
+
+
+/* A frame starts when the render task wakes up for the next snapshot. */
+void sim_frame_begin(void)
+{
+    priv_frame_start_ns = thread_cpu_time_ns();
+    priv_frame_start_spi_bytes = sim_stats.spi_bytes;
+    priv_frame_start_sim_us = sim_now_us();
+}
+
+
+static void restore_stdin(void)
+{
+    fcntl(STDIN_FILENO, F_SETFL, priv_stdin_flags);
+}
+
+
+void esp_restart(void)
+{
+    fprintf(stderr, "sim: esp_restart()\n");
+    sim_finish();
+    abort();
+}
+
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [--sdcard DIR] [--input SCRIPT] [--duration-ms N] [--dma-heap-kb N] [--ppm FILE] [--quiet]\n",
+            prog);
+}
+
+
+int main(int argc, char **argv)
+{
+    bool have_duration = false;
+    bool have_input = false;
+
+    for (int ix = 1; ix < argc; ix++)
+    {
+        const char *arg = argv[ix];
+        const char *val = (ix + 1 < argc) ? argv[ix + 1] : NULL;
+
+        if (strcmp(arg, "--quiet") == 0)
+        {
+            sim_log_enabled = false;
+            continue;
+        }
+
+        if (val == NULL)
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        if (strcmp(arg, "--sdcard") == 0)
+        {
+            sim_sdcard_set_root(val);
+        }
+        else if (strcmp(arg, "--input") == 0)
+        {
+            if (!sim_input_load(val))
+            {
+                fprintf(stderr, "sim: cannot read input script %s\n", val);
+                return EXIT_FAILURE;
+            }
+            have_input = true;
+        }
+        else if (strcmp(arg, "--duration-ms") == 0)
+        {
+            priv_duration_us = strtoll(val, NULL, 10) * 1000;
+            have_duration = true;
+        }
+        else if (strcmp(arg, "--dma-heap-kb") == 0)
+        {
+            sim_heap_set_internal_limit((size_t)strtoul(val, NULL, 10) * 1024u);
+        }
+        else if (strcmp(arg, "--ppm") == 0)
+        {
+            priv_ppm_path = val;
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        ix++;
+    }
+
+    /* By default run a little past the end of the script. */
+    if (have_input && !have_duration)
+    {
+        priv_duration_us = (sim_input_last_event_ms() + 2000) * 1000;
+    }
+
+    /* As on the board's console, reading stdin returns what has been typed and never waits. */
+    priv_stdin_flags = fcntl(STDIN_FILENO, F_GETFL);
+    if (priv_stdin_flags != -1)
+    {
+        fcntl(STDIN_FILENO, F_SETFL, priv_stdin_flags | O_NONBLOCK);
+        atexit(restore_stdin);
+    }
+
+    app_main();
+
+    /* As on the board the main task ends here, the tasks app_main() started keep running. The
+     * scheduler ends the run, right away if initialization failed and nothing was started. */
+    vTaskDelete(NULL);
+    return EXIT_SUCCESS;
+}
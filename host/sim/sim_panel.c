@@ -0,0 +1,176 @@
+/*
+ * sim_panel.c
+ *
+ * In-memory model of the ST7789 controller. Only the commands that move pixels are
+ * interpreted: CASET (0x2A), RASET (0x2B) and RAMWR (0x2C). Pixels are kept in wire order,
+ * i.e. the same byte layout the application keeps in its frame buffer.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+
+#define ST7789_CASET    0x2Au
+#define ST7789_RASET    0x2Bu
+#define ST7789_RAMWR    0x2Cu
+
+static uint16_t priv_panel[SIM_PANEL_WIDTH * SIM_PANEL_HEIGHT];
+
+static uint8_t priv_cmd;
+static uint8_t priv_params[4];
+static unsigned priv_param_count;
+
+static uint16_t priv_x0, priv_x1, priv_y0, priv_y1;
+static uint16_t priv_cx, priv_cy;
+
+static bool priv_have_half_pixel;
+static uint8_t priv_half_pixel;
+
+
+void sim_panel_reset(void)
+{
+    memset(priv_panel, 0, sizeof(priv_panel));
+    priv_cmd = 0u;
+    priv_param_count = 0u;
+    priv_x0 = 0u;
+    priv_x1 = SIM_PANEL_WIDTH - 1u;
+    priv_y0 = 0u;
+    priv_y1 = SIM_PANEL_HEIGHT - 1u;
+    priv_have_half_pixel = false;
+}
+
+
+void sim_panel_command(uint8_t cmd)
+{
+    priv_cmd = cmd;
+    priv_param_count = 0u;
+    priv_have_half_pixel = false;
+
+    if (cmd == ST7789_RAMWR)
+    {
+        priv_cx = priv_x0;
+        priv_cy = priv_y0;
+        sim_stats.spi_ramwr_count++;
+    }
+}
+
+
+static void write_pixel(uint8_t hi, uint8_t lo)
+{
+    if ((priv_cx < SIM_PANEL_WIDTH) && (priv_cy < SIM_PANEL_HEIGHT))
+    {
+        /* Stored with the same byte order as in the application buffers. */
+        priv_panel[priv_cy * SIM_PANEL_WIDTH + priv_cx] = (uint16_t)(hi | (lo << 8));
+    }
+
+    /* The controller wraps inside the address window. */
+    if (++priv_cx > priv_x1)
+    {
+        priv_cx = priv_x0;
+        if (++priv_cy > priv_y1)
+        {
+            priv_cy = priv_y0;
+        }
+    }
+}
+
+
+void sim_panel_data(const uint8_t *data, size_t len)
+{
+    size_t ix = 0u;
+
+    if ((priv_cmd == ST7789_CASET) || (priv_cmd == ST7789_RASET))
+    {
+        for (; (ix < len) && (priv_param_count < 4u); ix++)
+        {
+            priv_params[priv_param_count++] = data[ix];
+        }
+
+        if (priv_param_count == 4u)
+        {
+            uint16_t start = (uint16_t)((priv_params[0] << 8) | priv_params[1]);
+            uint16_t end = (uint16_t)((priv_params[2] << 8) | priv_params[3]);
+
+            if (priv_cmd == ST7789_CASET)
+            {
+                priv_x0 = start;
+                priv_x1 = end;
+            }
+            else
+            {
+                priv_y0 = start;
+                priv_y1 = end;
+            }
+        }
+    }
+    else if (priv_cmd == ST7789_RAMWR)
+    {
+        sim_stats.spi_pixel_bytes += len;
+
+        if (priv_have_half_pixel && (len > 0u))
+        {
+            write_pixel(priv_half_pixel, data[ix++]);
+            priv_have_half_pixel = false;
+        }
+
+        for (; (ix + 1u) < len; ix += 2u)
+        {
+            write_pixel(data[ix], data[ix + 1u]);
+        }
+
+        if (ix < len)
+        {
+            priv_half_pixel = data[ix];
+            priv_have_half_pixel = true;
+        }
+    }
+}
+
+
+const uint16_t *sim_panel_pixels(void)
+{
+    return priv_panel;
+}
+
+
+/* FNV-1a over the panel contents, to compare runs without storing images. */
+uint32_t sim_panel_checksum(void)
+{
+    const uint8_t *p = (const uint8_t *)priv_panel;
+    uint32_t hash = 2166136261u;
+
+    for (size_t ix = 0u; ix < sizeof(priv_panel); ix++)
+    {
+        hash = (hash ^ p[ix]) * 16777619u;
+    }
+
+    return hash;
+}
+
+
+bool sim_panel_write_ppm(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    fprintf(f, "P6\n%u %u\n255\n", SIM_PANEL_WIDTH, SIM_PANEL_HEIGHT);
+
+    for (size_t ix = 0u; ix < (SIM_PANEL_WIDTH * SIM_PANEL_HEIGHT); ix++)
+    {
+        /* Wire order: first byte RRRRRGGG, second byte GGGBBBBB */
+        uint16_t v = (uint16_t)(((priv_panel[ix] & 0xffu) << 8) | (priv_panel[ix] >> 8));
+        uint8_t rgb[3];
+
+        rgb[0] = (uint8_t)(((v >> 11) & 0x1fu) << 3);
+        rgb[1] = (uint8_t)(((v >> 5) & 0x3fu) << 2);
+        rgb[2] = (uint8_t)((v & 0x1fu) << 3);
+        fwrite(rgb, 1u, 3u, f);
+    }
+
+    fclose(f);
+    return true;
+}
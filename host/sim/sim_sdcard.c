@@ -0,0 +1,235 @@
+/*
+ * sim_sdcard.c
+ *
+ * SD card stand-in. The mount point is mapped onto a directory of the host file system.
+ * File access is counted in 512 byte sectors through a one-sector window per open file, as
+ * FATFS does, and every sector is charged to the shared SPI bus at the SDSPI clock. Like f_read,
+ * whole sectors covered by one read bypass the window and go out as a single multi-block read.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_vfs_fat.h"
+
+#include "sim.h"
+
+/* The stdio names are macros in esp_vfs_fat.h; the implementation needs the real ones. */
+#undef fopen
+#undef fread
+#undef fseek
+#undef fclose
+
+/* Command, response and CRC bytes on top of the data block for one CMD17 read. */
+#define SIM_SD_SECTOR_OVERHEAD_BYTES    24u
+/* A CMD18 read pays the command and the stop once, then only a data token and CRC per block. */
+#define SIM_SD_MULTI_BLOCK_OVERHEAD_BYTES 4u
+/* Directory entry plus FAT lookup done by f_open. */
+#define SIM_SD_OPEN_SECTORS             2u
+#define SIM_SD_MAX_OPEN_FILES           8
+
+typedef struct
+{
+    FILE *f;
+    long cached_sector;
+} sim_sd_file_t;
+
+static char priv_root[512] = "sdcard";
+static char priv_mount_point[64];
+static bool priv_mounted;
+static int priv_host;
+static int priv_freq_khz = SDMMC_FREQ_DEFAULT;
+static sim_sd_file_t priv_files[SIM_SD_MAX_OPEN_FILES];
+
+
+void sim_sdcard_set_root(const char *dir)
+{
+    snprintf(priv_root, sizeof(priv_root), "%s", dir);
+}
+
+
+const char *sim_sdcard_get_root(void)
+{
+    return priv_root;
+}
+
+
+esp_err_t esp_vfs_fat_sdspi_mount(const char *base_path, const sdmmc_host_t *host_config_input,
+                                  const sdspi_device_config_t *slot_config,
+                                  const esp_vfs_fat_sdmmc_mount_config_t *mount_config,
+                                  sdmmc_card_t **out_card)
+{
+    static sdmmc_card_t card;
+
+    (void)slot_config;
+    (void)mount_config;
+
+    snprintf(priv_mount_point, sizeof(priv_mount_point), "%s", base_path);
+    priv_host = host_config_input->slot;
+    priv_freq_khz = host_config_input->max_freq_khz;
+    priv_mounted = true;
+
+    card.max_freq_khz = priv_freq_khz;
+    *out_card = &card;
+
+    return ESP_OK;
+}
+
+
+static void charge_bytes(uint64_t bus_bytes)
+{
+    int64_t duration_us;
+
+    if (bus_bytes == 0u)
+    {
+        return;
+    }
+
+    duration_us = (int64_t)(bus_bytes * 8u * 1000u) / priv_freq_khz;
+    sim_stats.sd_bus_us += duration_us;
+
+    /* The read blocks the calling task until the card is done. */
+    sim_wait_until_us(sim_spi_bus_reserve(priv_host, duration_us));
+}
+
+
+/* Single-block reads, one command each. */
+static void charge_sectors(uint64_t sectors)
+{
+    sim_stats.sd_sectors_read += sectors;
+    charge_bytes(sectors * (SIM_SD_SECTOR_SIZE + SIM_SD_SECTOR_OVERHEAD_BYTES));
+}
+
+
+static void charge_multi_block(uint64_t sectors)
+{
+    sim_stats.sd_sectors_read += sectors;
+    charge_bytes((sectors * (SIM_SD_SECTOR_SIZE + SIM_SD_MULTI_BLOCK_OVERHEAD_BYTES)) + (2u * SIM_SD_SECTOR_OVERHEAD_BYTES));
+}
+
+
+static sim_sd_file_t *find_file(FILE *f)
+{
+    for (int ix = 0; ix < SIM_SD_MAX_OPEN_FILES; ix++)
+    {
+        if (priv_files[ix].f == f)
+        {
+            return &priv_files[ix];
+        }
+    }
+
+    return NULL;
+}
+
+
+FILE *sim_vfs_fopen(const char *path, const char *mode)
+{
+    size_t mp_len = strlen(priv_mount_point);
+    char host_path[1024];
+    sim_sd_file_t *slot;
+    FILE *f;
+
+    if (!priv_mounted || (strncmp(path, priv_mount_point, mp_len) != 0))
+    {
+        sim_stats.sd_open_failures++;
+        return NULL;
+    }
+
+    slot = find_file(NULL);
+    if (slot == NULL)
+    {
+        /* max_files exceeded */
+        sim_stats.sd_open_failures++;
+        return NULL;
+    }
+
+    snprintf(host_path, sizeof(host_path), "%s%s", priv_root, path + mp_len);
+    charge_sectors(SIM_SD_OPEN_SECTORS);
+
+    f = fopen(host_path, mode);
+    if (f == NULL)
+    {
+        sim_stats.sd_open_failures++;
+        return NULL;
+    }
+
+    slot->f = f;
+    slot->cached_sector = -1;
+    sim_stats.sd_files_opened++;
+
+    return f;
+}
+
+
+size_t sim_vfs_fread(void *ptr, size_t size, size_t nmemb, FILE *stream)
+{
+    sim_sd_file_t *file = find_file(stream);
+    long pos = ftell(stream);
+    size_t n = fread(ptr, size, nmemb, stream);
+    size_t bytes = n * size;
+
+    if ((file != NULL) && (bytes > 0u))
+    {
+        long end = pos + (long)bytes;
+        long sector = pos / (long)SIM_SD_SECTOR_SIZE;
+        long whole_end = end / (long)SIM_SD_SECTOR_SIZE;
+        uint64_t single = 0u;
+
+        /* Leading partial sector, through the window */
+        if (((pos % (long)SIM_SD_SECTOR_SIZE) != 0) || (sector >= whole_end))
+        {
+            if (sector != file->cached_sector)
+            {
+                single++;
+            }
+            file->cached_sector = sector;
+            sector++;
+        }
+
+        /* Whole sectors, straight into the caller's buffer */
+        if (whole_end - sector > 1)
+        {
+            charge_multi_block((uint64_t)(whole_end - sector));
+            sector = whole_end;
+        }
+        else if (whole_end - sector == 1)
+        {
+            single++;
+            sector = whole_end;
+        }
+
+        /* Trailing partial sector, through the window */
+        if ((sector * (long)SIM_SD_SECTOR_SIZE) < end)
+        {
+            if (sector != file->cached_sector)
+            {
+                single++;
+            }
+            file->cached_sector = sector;
+        }
+
+        sim_stats.sd_bytes_read += bytes;
+        charge_sectors(single);
+    }
+
+    return n;
+}
+
+
+int sim_vfs_fseek(FILE *stream, long offset, int whence)
+{
+    sim_stats.sd_seeks++;
+    return fseek(stream, offset, whence);
+}
+
+
+int sim_vfs_fclose(FILE *stream)
+{
+    sim_sd_file_t *file = find_file(stream);
+
+    if (file != NULL)
+    {
+        file->f = NULL;
+    }
+
+    return fclose(stream);
+}
@@ -0,0 +1,202 @@
+/*
+ * sim_spi.c
+ *
+ * SPI master stand-in. Every transaction is decoded by the ST7789 panel model the moment it
+ * is queued. Its completion time is computed from the device clock, so waiting for results
+ * moves the simulated clock the way a DMA transfer would on the board.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/spi_master.h"
+#include "driver/gpio.h"
+
+#include "sim.h"
+
+/* Fixed cost of setting up one transaction (driver, CS, DMA descriptor), roughly as measured on the S3. */
+#define SIM_SPI_TRANS_OVERHEAD_US   4
+#define SIM_SPI_HOST_COUNT          3
+#define SIM_SPI_MAX_QUEUE           128
+
+typedef struct
+{
+    spi_transaction_t *trans;
+    int64_t done_us;
+} sim_pending_t;
+
+struct spi_device_t
+{
+    spi_host_device_t host;
+    spi_device_interface_config_t cfg;
+    sim_pending_t pending[SIM_SPI_MAX_QUEUE];
+    int head;
+    int count;
+};
+
+static bool priv_bus_initialized[SIM_SPI_HOST_COUNT];
+static int64_t priv_bus_busy_until_us[SIM_SPI_HOST_COUNT];
+
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_common_dma_t dma_chan)
+{
+    (void)bus_config;
+    (void)dma_chan;
+
+    if ((host_id >= SIM_SPI_HOST_COUNT) || priv_bus_initialized[host_id])
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    priv_bus_initialized[host_id] = true;
+    return ESP_OK;
+}
+
+
+int64_t sim_spi_bus_reserve(int host, int64_t duration_us)
+{
+    int64_t start = sim_now_us();
+
+    if (priv_bus_busy_until_us[host] > start)
+    {
+        start = priv_bus_busy_until_us[host];
+    }
+
+    priv_bus_busy_until_us[host] = start + duration_us;
+    sim_stats.spi_bus_us += duration_us;
+
+    return priv_bus_busy_until_us[host];
+}
+
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config, spi_device_handle_t *handle)
+{
+    struct spi_device_t *dev;
+
+    if ((host_id >= SIM_SPI_HOST_COUNT) || !priv_bus_initialized[host_id])
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if ((dev_config->queue_size <= 0) || (dev_config->queue_size > SIM_SPI_MAX_QUEUE))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    dev = calloc(1, sizeof(*dev));
+    dev->host = host_id;
+    dev->cfg = *dev_config;
+    *handle = dev;
+
+    /* The display is the only spi_master client on the board, so the device is the panel. */
+    sim_panel_reset();
+
+    return ESP_OK;
+}
+
+
+/* Runs the transaction against the panel and returns its completion time. */
+static int64_t execute_transaction(spi_device_handle_t dev, spi_transaction_t *t)
+{
+    const uint8_t *data;
+    size_t len_bytes = (t->length + 7u) / 8u;
+    int64_t duration_us;
+
+    if (dev->cfg.pre_cb != NULL)
+    {
+        dev->cfg.pre_cb(t);
+    }
+
+    data = (t->flags & SPI_TRANS_USE_TXDATA) ? t->tx_data : (const uint8_t *)t->tx_buffer;
+
+    if ((len_bytes > 0u) && (data != NULL))
+    {
+        if (sim_gpio_output_level(SIM_LCD_PIN_DC) == 0u)
+        {
+            sim_panel_command(data[0]);
+        }
+        else
+        {
+            sim_panel_data(data, len_bytes);
+        }
+    }
+
+    sim_stats.spi_transactions++;
+    sim_stats.spi_bytes += len_bytes;
+
+    duration_us = SIM_SPI_TRANS_OVERHEAD_US + (((int64_t)t->length * 1000000) / dev->cfg.clock_speed_hz);
+    return sim_spi_bus_reserve(dev->host, duration_us);
+}
+
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, TickType_t ticks_to_wait)
+{
+    int slot;
+
+    if (handle->count >= handle->cfg.queue_size)
+    {
+        if (ticks_to_wait == portMAX_DELAY)
+        {
+            /* On the board the task would now block forever. */
+            fprintf(stderr, "sim: spi_device_queue_trans() on a full queue would never return\n");
+            abort();
+        }
+        return ESP_ERR_TIMEOUT;
+    }
+
+    slot = (handle->head + handle->count) % SIM_SPI_MAX_QUEUE;
+    handle->pending[slot].trans = trans_desc;
+    handle->pending[slot].done_us = execute_transaction(handle, trans_desc);
+    handle->count++;
+
+    return ESP_OK;
+}
+
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc, TickType_t ticks_to_wait)
+{
+    sim_pending_t *p;
+
+    if (handle->count == 0)
+    {
+        if (ticks_to_wait == portMAX_DELAY)
+        {
+            fprintf(stderr, "sim: spi_device_get_trans_result() with nothing queued would never return\n");
+            abort();
+        }
+        return ESP_ERR_TIMEOUT;
+    }
+
+    p = &handle->pending[handle->head];
+    sim_wait_until_us(p->done_us);
+
+    if (handle->cfg.post_cb != NULL)
+    {
+        handle->cfg.post_cb(p->trans);
+    }
+
+    *trans_desc = p->trans;
+    handle->head = (handle->head + 1) % SIM_SPI_MAX_QUEUE;
+    handle->count--;
+
+    return ESP_OK;
+}
+
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    if (handle->count != 0)
+    {
+        /* The real driver refuses polling transactions while queued ones are in flight. */
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    sim_wait_until_us(execute_transaction(handle, trans_desc));
+
+    if (handle->cfg.post_cb != NULL)
+    {
+        handle->cfg.post_cb(trans_desc);
+    }
+
+    return ESP_OK;
+}
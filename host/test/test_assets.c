@@ -0,0 +1,245 @@
+/*
+ * test_assets.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+ * Writes images with known pixels onto an empty simulated SD card, loads them with assets_init()
+ * and checks that every one draws back exactly as written. Images with more colours than their
+ * sprite pool class holds have to come back at 16 bits per pixel, not quantized, and the sprite
+ * pool has to be exactly as big as the sprites it holds. The images the test does not write fail
+ * to load, which is logged and otherwise ignored.
+ *
+ *   enginaator_test_assets --sdcard DIR [--quiet]
+ *
+ * Exits with EXIT_FAILURE if an image is not drawn as written or the pool size is off.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "spiBus.h"
+#include "sdCard.h"
+#include "assets.h"
+#include "assetFormat.h"
+#include "blit.h"
+
+#include "sim.h"
+
+/* Where nothing has been drawn. No test image uses this colour. */
+#define TEST_BACKGROUND     0x1234u
+
+#define TEST_MAX_PIXELS     (156u * 40u)
+
+typedef uint16_t (*test_pixel_fn_t)(int x, int y);
+
+typedef struct
+{
+    asset_handle_t handle;
+    const char * path;              /* On the card */
+    uint16_t width;
+    uint16_t height;
+    test_pixel_fn_t pixel;
+    uint8_t bits_per_pixel;         /* Expected after loading */
+} test_image_t;
+
+static uint16_t few_colors(int x, int y);
+static uint16_t seventeen_colors(int x, int y);
+static uint16_t keyed_many_colors(int x, int y);
+static uint16_t all_different(int x, int y);
+
+static const test_image_t priv_images[] =
+{
+    /* Fits its 4 bpp class and stays indexed */
+    { ASSET_CHERRY,     "/images/cherry.565",     20, 20, few_colors,        4u  },
+    /* One colour more than 4 bpp holds */
+    { ASSET_LVL1,       "/images/lvl1.565",      100, 40, seventeen_colors,  16u },
+    /* Keyed, so it also gets a run table at 16 bpp */
+    { ASSET_APPLE,      "/images/apple.565",      20, 20, keyed_many_colors, 16u },
+    /* More colours than 8 bpp holds */
+    { ASSET_ENGINAATOR, "/enginaator.565",       156, 40, all_different,     16u },
+};
+
+static uint16_t priv_pixels[TEST_MAX_PIXELS];
+static uint16_t priv_drawn[TEST_MAX_PIXELS];
+
+
+static uint16_t few_colors(int x, int y)
+{
+    static const uint16_t colors[] = { ASSET_COLOR_KEY, 0xF800u, 0x07E0u, 0x001Fu };
+    return colors[(x / 5 + y / 5) % 4];
+}
+
+
+static uint16_t seventeen_colors(int x, int y)
+{
+    return (uint16_t)(0x0841u * (uint16_t)((x + y) % 17));
+}
+
+
+/* A quarter of the pixels are transparent, the rest have 40 colours. */
+static uint16_t keyed_many_colors(int x, int y)
+{
+    return ((x + y) % 4 == 0) ? ASSET_COLOR_KEY : (uint16_t)(0x2000u + (uint16_t)((x * 20 + y) % 40));
+}
+
+
+static uint16_t all_different(int x, int y)
+{
+    return (uint16_t)(0x4000u + (uint16_t)(y * 156 + x));
+}
+
+
+/* Writes the image as a precompiled .565 file. */
+static bool write_image(const test_image_t * image)
+{
+    asset_rgb565_header_t header = { .magic = ASSET_RGB565_MAGIC, .version = ASSET_RGB565_VERSION,
+                                     .width = image->width, .height = image->height };
+    uint32_t count = (uint32_t)image->width * image->height;
+    char path[512];
+    FILE * f;
+    bool ok;
+
+    for (int y = 0; y < image->height; y++)
+    {
+        for (int x = 0; x < image->width; x++)
+        {
+            priv_pixels[(y * image->width) + x] = image->pixel(x, y);
+        }
+    }
+
+    snprintf(path, sizeof(path), "%s%s", sim_sdcard_get_root(), image->path);
+    f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        return false;
+    }
+    ok = (fwrite(&header, sizeof(header), 1u, f) == 1u) && (fwrite(priv_pixels, sizeof(uint16_t), count, f) == count);
+    return (fclose(f) == 0) && ok;
+}
+
+
+/* Draws the loaded sprite over TEST_BACKGROUND and compares it with what was written. */
+static bool check_image(const test_image_t * image)
+{
+    const asset_sprite_t * sprite = assets_get(image->handle);
+    blit_surface_t surface = { .pixels = priv_drawn, .x = 0, .y = 0,
+                               .width = image->width, .height = image->height, .stride = image->width };
+
+    if ((sprite->width != image->width) || (sprite->height != image->height))
+    {
+        printf("FAIL %s: loaded as %u x %u\n", image->path, sprite->width, sprite->height);
+        return false;
+    }
+    if (sprite->bits_per_pixel != image->bits_per_pixel)
+    {
+        printf("FAIL %s: kept at %u bits per pixel, expected %u\n", image->path, sprite->bits_per_pixel, image->bits_per_pixel);
+        return false;
+    }
+
+    blit_fill(&surface, 0, 0, image->width, image->height, TEST_BACKGROUND);
+    assets_draw(&surface, 0, 0, image->handle, NULL);
+
+    for (int y = 0; y < image->height; y++)
+    {
+        for (int x = 0; x < image->width; x++)
+        {
+            uint16_t expected = image->pixel(x, y);
+            uint16_t drawn = priv_drawn[(y * image->width) + x];
+
+            if (sprite->keyed && (expected == ASSET_COLOR_KEY))
+            {
+                expected = TEST_BACKGROUND;
+            }
+            if (drawn != expected)
+            {
+                printf("FAIL %s: pixel %d, %d is %04x, expected %04x\n", image->path, x, y, drawn, expected);
+                return false;
+            }
+        }
+    }
+
+    printf("ok   %s at %u bits per pixel\n", image->path, sprite->bits_per_pixel);
+    return true;
+}
+
+
+/* The pool is all the memory the sprites take, a slot rounded up to a whole word. */
+static bool check_total_bytes(void)
+{
+    uint32_t expected = 0u;
+
+    for (int ix = 0; ix < NUMBER_OF_ASSETS; ix++)
+    {
+        const asset_sprite_t * sprite = assets_get((asset_handle_t)ix);
+        uint32_t bytes;
+
+        if (sprite->bits_per_pixel == 16u)
+        {
+            bytes = (uint32_t)sprite->width * sprite->height * sizeof(uint16_t);
+        }
+        else
+        {
+            bytes = (BLIT_PALETTE_ENTRIES(sprite->bits_per_pixel) * sizeof(uint16_t)) +
+                    (BLIT_INDEXED_ROW_BYTES((uint32_t)sprite->width, sprite->bits_per_pixel) * sprite->height);
+        }
+        expected += (bytes + 3u) & ~3u;
+    }
+
+    if (assets_getTotalBytes() != expected)
+    {
+        printf("FAIL the atlas takes %u bytes, its sprites %u\n", (unsigned)assets_getTotalBytes(), (unsigned)expected);
+        return false;
+    }
+
+    printf("ok   atlas of %u bytes\n", (unsigned)expected);
+    return true;
+}
+
+
+void app_main(void)
+{
+    char path[512];
+    bool passed = true;
+
+    sim_set_end_us(INT64_MAX);
+
+    snprintf(path, sizeof(path), "%s/images", sim_sdcard_get_root());
+    if (((mkdir(sim_sdcard_get_root(), 0777) != 0) && (errno != EEXIST)) ||
+        ((mkdir(path, 0777) != 0) && (errno != EEXIST)))
+    {
+        printf("FAIL cannot create %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t ix = 0; ix < (sizeof(priv_images) / sizeof(priv_images[0])); ix++)
+    {
+        if (!write_image(&priv_images[ix]))
+        {
+            printf("FAIL cannot write %s\n", priv_images[ix].path);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (!spiBus_init())
+    {
+        exit(EXIT_FAILURE);
+    }
+    sdCard_init();
+    assets_init();
+
+    for (size_t ix = 0; ix < (sizeof(priv_images) / sizeof(priv_images[0])); ix++)
+    {
+        passed = check_image(&priv_images[ix]) && passed;
+    }
+    passed = check_total_bytes() && passed;
+
+    fflush(stdout);
+    exit(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
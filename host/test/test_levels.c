@@ -0,0 +1,107 @@
+/*
+ * test_levels.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+ * Loads the levels from the simulator's SD card with level_init() and checks that every one was
+ * read from its file, and that its collision grid has walls where the game always had them:
+ *
+ *   level 1   none on the board
+ *   level 2   the cells under the logo, 82..237 x 100..139 on the screen
+ *   level 3   none on the board
+ *
+ * Every cell one step off the board has to be solid as well. All three levels start the snake on
+ * a random cell, moving right.
+ *
+ *   enginaator_test_levels --sdcard DIR [--quiet]
+ *
+ * Exits with EXIT_FAILURE if a level does not match.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "spiBus.h"
+#include "sdCard.h"
+#include "level.h"
+
+#include "sim.h"
+
+/* Cells under the logo on level 2 */
+#define LOGO_FIRST_COLUMN   4
+#define LOGO_LAST_COLUMN    11
+#define LOGO_FIRST_ROW      5
+#define LOGO_LAST_ROW       6
+
+
+static bool expect_solid(uint8_t number, int column, int row)
+{
+    if ((column < 0) || (column >= (int)GRID_COLUMNS) || (row < 0) || (row >= (int)GRID_ROWS))
+    {
+        return true;
+    }
+
+    return (number == 2u) &&
+           (column >= LOGO_FIRST_COLUMN) && (column <= LOGO_LAST_COLUMN) &&
+           (row >= LOGO_FIRST_ROW) && (row <= LOGO_LAST_ROW);
+}
+
+
+static bool check_level(uint8_t number)
+{
+    const level_t * level = level_get(number);
+
+    if (!level->from_card)
+    {
+        printf("FAIL level %u: not read from the card\n", (unsigned)number);
+        return false;
+    }
+    if (!level->random_spawn || (level->direction != LEVEL_DIRECTION_RIGHT))
+    {
+        printf("FAIL level %u: the snake does not start on a random cell moving right\n", (unsigned)number);
+        return false;
+    }
+
+    for (int row = -1; row <= (int)GRID_ROWS; row++)
+    {
+        for (int column = -1; column <= (int)GRID_COLUMNS; column++)
+        {
+            if (level_isSolid(level, column, row) != expect_solid(number, column, row))
+            {
+                printf("FAIL level %u: cell %d, %d is %s\n", (unsigned)number, column, row,
+                       level_isSolid(level, column, row) ? "a wall" : "floor");
+                return false;
+            }
+        }
+    }
+
+    printf("ok   level %u\n", (unsigned)number);
+    return true;
+}
+
+
+void app_main(void)
+{
+    bool passed = true;
+
+    sim_set_end_us(INT64_MAX);
+
+    if (!spiBus_init())
+    {
+        exit(EXIT_FAILURE);
+    }
+    sdCard_init();
+    level_init();
+
+    for (uint8_t number = 1u; number <= LEVEL_COUNT; number++)
+    {
+        passed = check_level(number) && passed;
+    }
+
+    fflush(stdout);
+    exit(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
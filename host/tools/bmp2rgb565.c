@@ -0,0 +1,212 @@
+/*
+ * bmp2rgb565.c
+ *
+ * Converts 24 bit and 4 or 8 bit indexed BMPs into the precompiled RGB565 format the game loads without a conversion
+ * pass (see main/assetFormat.h). Every x.bmp becomes x.565 next to it. Directory arguments are
+ * converted file by file, without descending into subdirectories.
+ *
+ *     bmp2rgb565 <file.bmp | directory>...
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "display.h"
+#include "assetFormat.h"
+
+static uint32_t get_u32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t get_u16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+
+static int convert(const char *bmp_path)
+{
+    uint8_t header[54];
+    char out_path[1024];
+    asset_rgb565_header_t out_header = { .magic = ASSET_RGB565_MAGIC, .version = ASSET_RGB565_VERSION };
+    FILE *in = fopen(bmp_path, "rb");
+    FILE *out = NULL;
+    uint8_t *line = NULL;
+    uint16_t *pixels = NULL;
+    uint16_t color_table[256] = { 0 };
+    int32_t width, height;
+    uint32_t bits_per_pixel, lines, stride;
+    int ret = -1;
+
+    if ((in == NULL) || (fread(header, 1, sizeof(header), in) != sizeof(header)))
+    {
+        fprintf(stderr, "%s: cannot read header\n", bmp_path);
+        goto done;
+    }
+
+    width = (int32_t)get_u32(&header[18]);
+    height = (int32_t)get_u32(&header[22]);
+    bits_per_pixel = get_u16(&header[28]);
+
+    if ((get_u16(&header[0]) != 0x4d42u) || (get_u32(&header[30]) != 0u) ||
+        ((bits_per_pixel != 24u) && (bits_per_pixel != 8u) && (bits_per_pixel != 4u)) ||
+        (width <= 0) || (width > 0xffff) || (height == 0) || (height < -0xffff) || (height > 0xffff))
+    {
+        fprintf(stderr, "%s: not an uncompressed 4, 8 or 24 bpp BMP\n", bmp_path);
+        goto done;
+    }
+
+    if (bits_per_pixel != 24u)
+    {
+        /* The colour table, 4 byte BGRX entries, follows the DIB header. */
+        uint32_t colors = get_u32(&header[46]);
+        uint8_t bgrx[4];
+
+        if ((colors == 0u) || (colors > (1u << bits_per_pixel)))
+        {
+            colors = 1u << bits_per_pixel;
+        }
+
+        if (fseek(in, 14L + (long)get_u32(&header[14]), SEEK_SET) != 0)
+        {
+            goto done;
+        }
+
+        for (uint32_t ix = 0; ix < colors; ix++)
+        {
+            if (fread(bgrx, 1, sizeof(bgrx), in) != sizeof(bgrx))
+            {
+                fprintf(stderr, "%s: colour table is truncated\n", bmp_path);
+                goto done;
+            }
+            color_table[ix] = CONVERT_888RGB_TO_565RGB(bgrx[2], bgrx[1], bgrx[0]);
+        }
+    }
+
+    lines = (uint32_t)((height < 0) ? -height : height);
+    stride = (((uint32_t)width * bits_per_pixel + 31u) / 32u) * 4u;
+    line = malloc(stride);
+    pixels = malloc((size_t)width * lines * sizeof(uint16_t));
+
+    if ((line == NULL) || (pixels == NULL) || (fseek(in, (long)get_u32(&header[10]), SEEK_SET) != 0))
+    {
+        goto done;
+    }
+
+    for (uint32_t y = 0; y < lines; y++)
+    {
+        /* Rows are stored bottom-up unless the height is negative. */
+        uint16_t *dest = &pixels[(size_t)((height > 0) ? (lines - 1u - y) : y) * width];
+
+        if (fread(line, 1, stride, in) != stride)
+        {
+            fprintf(stderr, "%s: pixel data is truncated\n", bmp_path);
+            goto done;
+        }
+
+        for (int32_t x = 0; x < width; x++)
+        {
+            if (bits_per_pixel == 8u)
+            {
+                dest[x] = color_table[line[x]];
+            }
+            else if (bits_per_pixel == 4u)
+            {
+                /* The left pixel is in the high nibble. */
+                dest[x] = color_table[(x & 1) ? (line[x >> 1] & 0x0fu) : (line[x >> 1] >> 4)];
+            }
+            else
+            {
+                const uint8_t *bgr = &line[x * 3];
+                dest[x] = CONVERT_888RGB_TO_565RGB(bgr[2], bgr[1], bgr[0]);
+            }
+        }
+    }
+
+    snprintf(out_path, sizeof(out_path), "%.*s" ASSET_RGB565_EXTENSION, (int)(strlen(bmp_path) - 4), bmp_path);
+    out_header.width = (uint16_t)width;
+    out_header.height = (uint16_t)lines;
+    out = fopen(out_path, "wb");
+
+    /* The target is little endian like the hosts this runs on, so the pixels are written as they are. */
+    if ((out == NULL) ||
+        (fwrite(&out_header, sizeof(out_header), 1, out) != 1) ||
+        (fwrite(pixels, sizeof(uint16_t), (size_t)width * lines, out) != (size_t)width * lines))
+    {
+        fprintf(stderr, "%s: cannot write\n", out_path);
+        goto done;
+    }
+
+    ret = 0;
+
+done:
+    if (out != NULL) fclose(out);
+    if (in != NULL) fclose(in);
+    free(line);
+    free(pixels);
+    return ret;
+}
+
+
+static int has_bmp_extension(const char *name)
+{
+    size_t len = strlen(name);
+    return (len > 4) && (strcmp(&name[len - 4], ".bmp") == 0);
+}
+
+
+static int convert_directory(const char *dir_path)
+{
+    DIR *dir = opendir(dir_path);
+    struct dirent *entry;
+    char path[1024];
+    int ret = 0;
+
+    if (dir == NULL)
+    {
+        fprintf(stderr, "%s: cannot open\n", dir_path);
+        return -1;
+    }
+
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (has_bmp_extension(entry->d_name))
+        {
+            snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+            ret |= convert(path);
+        }
+    }
+
+    closedir(dir);
+    return ret;
+}
+
+
+int main(int argc, char **argv)
+{
+    int ret = 0;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <file.bmp | directory>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (int ix = 1; ix < argc; ix++)
+    {
+        struct stat st;
+
+        if ((stat(argv[ix], &st) == 0) && S_ISDIR(st.st_mode))
+        {
+            ret |= convert_directory(argv[ix]);
+        }
+        else if (has_bmp_extension(argv[ix]))
+        {
+            ret |= convert(argv[ix]);
+        }
+        else
+        {
+            fprintf(stderr, "%s: not a .bmp file or a directory\n", argv[ix]);
+            ret = -1;
+        }
+    }
+
+    return (ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,180 @@
+/*
+ * gen_assets.c
+ *
+ * Writes a placeholder SD card image with every BMP the game loads, at the sizes the game
+ * expects, so that the host build can run without the real artwork. Sprites are drawn on a
+ * white background (the colour the game treats as empty), buttons get a border, and every
+ * image has a black marker in its top left corner so flipped or transposed blits show up.
+ * The speed images are stored top-down, the rest bottom-up, so both row orders get loaded.
+ *
+ *     gen_assets <output dir>
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+typedef enum
+{
+    STYLE_SPRITE,
+    STYLE_BUTTON,
+    STYLE_LOGO,
+} asset_style_t;
+
+typedef struct
+{
+    const char *path;
+    int width;
+    int height;
+    uint8_t r, g, b;
+    asset_style_t style;
+    bool top_down;
+} asset_def_t;
+
+static const asset_def_t assets[] =
+{
+    { "images/snake_head.bmp",  20,  20,   0, 128,   0, STYLE_SPRITE, false },
+    { "images/snake_body.bmp",  20,  20,   0, 200,   0, STYLE_SPRITE, false },
+    { "images/apple.bmp",       20,  20, 220,  20,  20, STYLE_SPRITE, false },
+    { "images/cherry.bmp",      20,  20, 160,   0,  40, STYLE_SPRITE, false },
+    { "images/grapes.bmp",      20,  20, 110,  40, 160, STYLE_SPRITE, false },
+    { "images/pineapple.bmp",   20,  20, 230, 190,  30, STYLE_SPRITE, false },
+    { "images/tomato.bmp",      20,  20, 250,  80,  50, STYLE_SPRITE, false },
+    { "images/watermelon.bmp",  20,  20,  40, 170,  70, STYLE_SPRITE, false },
+    { "images/lvl1.bmp",       100,  40, 180, 180, 180, STYLE_BUTTON, false },
+    { "images/lvl1h.bmp",      100,  40, 255, 165,   0, STYLE_BUTTON, false },
+    { "images/lvl2.bmp",       100,  40, 170, 170, 190, STYLE_BUTTON, false },
+    { "images/lvl2h.bmp",      100,  40, 255, 140,   0, STYLE_BUTTON, false },
+    { "images/lvl3.bmp",       100,  40, 160, 190, 170, STYLE_BUTTON, false },
+    { "images/lvl3h.bmp",      100,  40, 255, 120,   0, STYLE_BUTTON, false },
+    { "images/options.bmp",    100,  40, 150, 150, 200, STYLE_BUTTON, false },
+    { "images/optionsh.bmp",   100,  40, 255, 100,  60, STYLE_BUTTON, false },
+    { "images/speed1.bmp",     100,  20,  80, 200,  80, STYLE_BUTTON, true  },
+    { "images/speed2.bmp",     100,  20, 200, 200,  80, STYLE_BUTTON, true  },
+    { "images/speed3.bmp",     100,  20, 200,  80,  80, STYLE_BUTTON, true  },
+    { "enginaator.bmp",        156,  40,  20,  40, 120, STYLE_LOGO,   false },
+};
+
+
+static void put_u16(uint8_t *p, uint16_t v) { p[0] = v & 0xff; p[1] = v >> 8; }
+static void put_u32(uint8_t *p, uint32_t v) { put_u16(p, v & 0xffff); put_u16(p + 2, v >> 16); }
+
+
+/* Colour of pixel (x, y), y counted from the top of the image. */
+static void pixel_colour(const asset_def_t *a, int x, int y, uint8_t *rgb)
+{
+    int border;
+
+    rgb[0] = a->r; rgb[1] = a->g; rgb[2] = a->b;
+
+    if ((x < 3) && (y < 3))
+    {
+        rgb[0] = rgb[1] = rgb[2] = 0;
+        return;
+    }
+
+    switch (a->style)
+    {
+        case STYLE_SPRITE:
+        {
+            int dx = 2 * x + 1 - a->width;
+            int dy = 2 * y + 1 - a->height;
+            if ((dx * dx + dy * dy) > ((a->width - 2) * (a->width - 2)))
+            {
+                rgb[0] = rgb[1] = rgb[2] = 255;
+            }
+            break;
+        }
+        case STYLE_BUTTON:
+            border = (x < 2) || (y < 2) || (x >= a->width - 2) || (y >= a->height - 2);
+            if (border)
+            {
+                rgb[0] = rgb[1] = rgb[2] = 40;
+            }
+            break;
+        case STYLE_LOGO:
+            if (((x / 12) + (y / 10)) & 1)
+            {
+                rgb[0] = 250; rgb[1] = 250; rgb[2] = 250;
+            }
+            break;
+    }
+}
+
+
+static int write_bmp(const char *path, const asset_def_t *a)
+{
+    int stride = (a->width * 3 + 3) & ~3;
+    uint32_t image_size = (uint32_t)(stride * a->height);
+    uint8_t header[54] = { 'B', 'M' };
+    uint8_t *row = calloc(1, (size_t)stride);
+    FILE *f = fopen(path, "wb");
+
+    if ((f == NULL) || (row == NULL))
+    {
+        free(row);
+        return -1;
+    }
+
+    put_u32(&header[2], 54u + image_size);
+    put_u32(&header[10], 54u);
+    put_u32(&header[14], 40u);
+    put_u32(&header[18], (uint32_t)a->width);
+    put_u32(&header[22], a->top_down ? (uint32_t)-a->height : (uint32_t)a->height);
+    put_u16(&header[26], 1u);
+    put_u16(&header[28], 24u);
+    put_u32(&header[34], image_size);
+    put_u32(&header[38], 2835u);
+    put_u32(&header[42], 2835u);
+    fwrite(header, 1, sizeof(header), f);
+
+    /* BGR, bottom-up unless the height is negative */
+    for (int ix = 0; ix < a->height; ix++)
+    {
+        int y = a->top_down ? ix : (a->height - 1 - ix);
+
+        for (int x = 0; x < a->width; x++)
+        {
+            uint8_t rgb[3];
+            pixel_colour(a, x, y, rgb);
+            row[x * 3 + 0] = rgb[2];
+            row[x * 3 + 1] = rgb[1];
+            row[x * 3 + 2] = rgb[0];
+        }
+        fwrite(row, 1, (size_t)stride, f);
+    }
+
+    free(row);
+    fclose(f);
+    return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+    char path[1024];
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s <output dir>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    mkdir(argv[1], 0755);
+    snprintf(path, sizeof(path), "%s/images", argv[1]);
+    mkdir(path, 0755);
+
+    for (size_t ix = 0; ix < sizeof(assets) / sizeof(assets[0]); ix++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", argv[1], assets[ix].path);
+        if (write_bmp(path, &assets[ix]) != 0)
+        {
+            fprintf(stderr, "gen_assets: cannot write %s\n", path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
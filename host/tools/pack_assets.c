@@ -0,0 +1,230 @@
+/*
+ * pack_assets.c
+ *
+ * Bundles every precompiled image (.565, see bmp2rgb565) under a card directory into one asset
+ * pack, so the game opens a single file at boot (see main/assetFormat.h). Entries are named by
+ * their path relative to the card root without the extension, e.g. "/images/apple".
+ *
+ *     pack_assets <card dir> [output file, default <card dir>/assets.pak]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "assetFormat.h"
+
+/* Entry data starts on a 4 byte boundary. */
+#define PACK_ALIGNMENT 4u
+
+typedef struct
+{
+    char name[256];
+    char path[1024];
+    asset_rgb565_header_t header;
+} input_t;
+
+static input_t priv_inputs[ASSET_PACK_MAX_ENTRIES];
+static size_t priv_input_count;
+
+
+static int has_extension(const char *name, const char *ext)
+{
+    size_t len = strlen(name);
+    size_t ext_len = strlen(ext);
+    return (len > ext_len) && (strcmp(&name[len - ext_len], ext) == 0);
+}
+
+
+static int add_input(const char *path, const char *name)
+{
+    input_t *in;
+    FILE *f;
+
+    if (priv_input_count == ASSET_PACK_MAX_ENTRIES)
+    {
+        fprintf(stderr, "more than %u images\n", ASSET_PACK_MAX_ENTRIES);
+        return -1;
+    }
+
+    in = &priv_inputs[priv_input_count];
+    f = fopen(path, "rb");
+
+    if ((f == NULL) || (fread(&in->header, sizeof(in->header), 1, f) != 1) ||
+        (in->header.magic != ASSET_RGB565_MAGIC) || (in->header.version != ASSET_RGB565_VERSION))
+    {
+        fprintf(stderr, "%s: not a precompiled image\n", path);
+        if (f != NULL) fclose(f);
+        return -1;
+    }
+
+    fclose(f);
+    snprintf(in->path, sizeof(in->path), "%s", path);
+    snprintf(in->name, sizeof(in->name), "%.*s", (int)(strlen(name) - strlen(ASSET_RGB565_EXTENSION)), name);
+    priv_input_count++;
+
+    return 0;
+}
+
+
+/* name is the path below the card root, starting with '/'. */
+static int scan(const char *dir_path, const char *name)
+{
+    DIR *dir = opendir(dir_path);
+    struct dirent *entry;
+    int ret = 0;
+
+    if (dir == NULL)
+    {
+        fprintf(stderr, "%s: cannot open\n", dir_path);
+        return -1;
+    }
+
+    while (((entry = readdir(dir)) != NULL) && (ret == 0))
+    {
+        char path[1024];
+        char child[256];
+        struct stat st;
+
+        if (entry->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        if (((size_t)snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name) >= sizeof(path)) ||
+            ((size_t)snprintf(child, sizeof(child), "%s/%s", name, entry->d_name) >= sizeof(child)))
+        {
+            fprintf(stderr, "%s/%s: path too long, skipped\n", dir_path, entry->d_name);
+            continue;
+        }
+
+        if ((stat(path, &st) == 0) && S_ISDIR(st.st_mode))
+        {
+            ret = scan(path, child);
+        }
+        else if (has_extension(entry->d_name, ASSET_RGB565_EXTENSION))
+        {
+            ret = add_input(path, child);
+        }
+    }
+
+    closedir(dir);
+    return ret;
+}
+
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(((const input_t *)a)->name, ((const input_t *)b)->name);
+}
+
+
+static int copy_pixels(FILE *out, const input_t *in, uint32_t size)
+{
+    FILE *f = fopen(in->path, "rb");
+    uint8_t *data = malloc(size);
+    int ret = -1;
+
+    if ((f != NULL) && (data != NULL) && (fseek(f, sizeof(asset_rgb565_header_t), SEEK_SET) == 0) &&
+        (fread(data, 1, size, f) == size) && (fwrite(data, 1, size, out) == size))
+    {
+        ret = 0;
+    }
+    else
+    {
+        fprintf(stderr, "%s: pixel data is truncated\n", in->path);
+    }
+
+    if (f != NULL) fclose(f);
+    free(data);
+    return ret;
+}
+
+
+int main(int argc, char **argv)
+{
+    static asset_pack_entry_t toc[ASSET_PACK_MAX_ENTRIES];
+    asset_pack_header_t header = { .magic = ASSET_PACK_MAGIC, .version = ASSET_PACK_VERSION };
+    char out_path[1024];
+    uint32_t offset;
+    FILE *out;
+
+    if ((argc < 2) || (argc > 3))
+    {
+        fprintf(stderr, "usage: %s <card dir> [output file]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (argc == 3)
+    {
+        snprintf(out_path, sizeof(out_path), "%s", argv[2]);
+    }
+    else
+    {
+        snprintf(out_path, sizeof(out_path), "%s%s", argv[1], ASSET_PACK_PATH);
+    }
+
+    if (scan(argv[1], "") != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    /* Sorted, so the same images always give the same pack. */
+    qsort(priv_inputs, priv_input_count, sizeof(input_t), compare_names);
+
+    header.entry_count = (uint16_t)priv_input_count;
+    offset = sizeof(header) + (priv_input_count * sizeof(asset_pack_entry_t));
+
+    for (size_t ix = 0; ix < priv_input_count; ix++)
+    {
+        const input_t *in = &priv_inputs[ix];
+
+        offset = (offset + PACK_ALIGNMENT - 1u) & ~(PACK_ALIGNMENT - 1u);
+        toc[ix].name_hash = assetFormat_hashName(in->name);
+        toc[ix].offset = offset;
+        toc[ix].size = (uint32_t)in->header.width * in->header.height * sizeof(uint16_t);
+        toc[ix].width = in->header.width;
+        toc[ix].height = in->header.height;
+        toc[ix].format = ASSET_FORMAT_RGB565;
+        offset += toc[ix].size;
+
+        for (size_t other = 0; other < ix; other++)
+        {
+            if (toc[other].name_hash == toc[ix].name_hash)
+            {
+                fprintf(stderr, "%s and %s have the same name hash, rename one\n", priv_inputs[other].name, in->name);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    out = fopen(out_path, "wb");
+
+    if ((out == NULL) || (fwrite(&header, sizeof(header), 1, out) != 1) ||
+        (fwrite(toc, sizeof(asset_pack_entry_t), priv_input_count, out) != priv_input_count))
+    {
+        fprintf(stderr, "%s: cannot write\n", out_path);
+        return EXIT_FAILURE;
+    }
+
+    for (size_t ix = 0; ix < priv_input_count; ix++)
+    {
+        static const uint8_t padding[PACK_ALIGNMENT];
+        long pad = (long)toc[ix].offset - ftell(out);
+
+        if ((fwrite(padding, 1, (size_t)pad, out) != (size_t)pad) || (copy_pixels(out, &priv_inputs[ix], toc[ix].size) != 0))
+        {
+            fclose(out);
+            return EXIT_FAILURE;
+        }
+
+        printf("%-24s %3u x %3u  offset %6u\n", priv_inputs[ix].name, toc[ix].width, toc[ix].height, toc[ix].offset);
+    }
+
+    fclose(out);
+    printf("%s: %zu images, %u bytes\n", out_path, priv_input_count, offset);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+/*
+ * assetFormat.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_ASSETFORMAT_H_
+#define MAIN_ASSETFORMAT_H_
+
+#include <stdint.h>
+
+/* Precompiled image, written from a BMP by host/tools/bmp2rgb565. The header is followed by
+ * width * height pixels, top line first, already converted with CONVERT_888RGB_TO_565RGB so
+ * they can be sent to the panel as they are. All fields are little endian. */
+#define ASSET_RGB565_MAGIC      0x35363552u     /* "R565" */
+#define ASSET_RGB565_VERSION    1u
+#define ASSET_RGB565_EXTENSION  ".565"
+
+#pragma pack(push)
+#pragma pack(1)
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t width;
+    uint16_t height;
+    uint16_t reserved[3];       /* Pads the header to 16 bytes */
+} asset_rgb565_header_t;
+#pragma pack(pop)
+
+/* Bundle of images, written by host/tools/pack_assets. A header and a table of contents are followed
+ * by the data of every entry. Entries are found by the hash of their name, which is the path the
+ * image has on the card without the extension, e.g. "/images/apple". */
+#define ASSET_PACK_PATH         "/assets.pak"
+#define ASSET_PACK_MAGIC        0x4b415045u     /* "EPAK" */
+#define ASSET_PACK_VERSION      1u
+#define ASSET_PACK_MAX_ENTRIES  64u
+
+/* Entry formats */
+#define ASSET_FORMAT_RGB565     1u              /* width * height pixels as in a .565 file */
+
+#pragma pack(push)
+#pragma pack(1)
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entry_count;
+} asset_pack_header_t;
+
+typedef struct
+{
+    uint32_t name_hash;
+    uint32_t offset;            /* From the start of the file */
+    uint32_t size;              /* In bytes */
+    uint16_t width;
+    uint16_t height;
+    uint8_t  format;
+    uint8_t  reserved[3];
+} asset_pack_entry_t;
+#pragma pack(pop)
+
+/* 32 bit FNV-1a, shared by the packer and the loader. */
+static inline uint32_t assetFormat_hashName(const char * name)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*name != '\0')
+    {
+        hash = (hash ^ (uint8_t)*name++) * 16777619u;
+    }
+
+    return hash;
+}
+
+#endif /* MAIN_ASSETFORMAT_H_ */
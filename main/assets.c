@@ -0,0 +1,396 @@
+/*
+ * assets.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "assets.h"
+#include "sdCard.h"
+#include "spritePool.h"
+#include "assetFormat.h"
+#include "blit.h"
+#include "palette.h"
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+/* The largest image, the logo. Indexed images are read at full colour into a scratch buffer of
+ * this size first. */
+#define LOAD_SCRATCH_PIXELS     (156u * 40u)
+
+/* Run tables of the keyed sprites. A 20x20 sprite needs a byte per row plus two for every opaque
+ * span, so this leaves room for shapes with many holes. */
+#define RUN_TABLE_SIZE          2048u
+
+/* The scratch buffer only lives while assets_init() runs. */
+#define LOAD_SCRATCH_PRIMARY_CAPS   (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#define LOAD_SCRATCH_FALLBACK_CAPS  (MALLOC_CAP_8BIT)
+
+/*
+**====================================================================================
+** Private type definitions
+**====================================================================================
+*/
+
+typedef struct
+{
+    const char * name;      /* Path on the card without the extension */
+    uint16_t width;
+    uint16_t height;
+    uint8_t bits_per_pixel; /* How it is kept in memory unless it has more colours, must match a sprite pool class */
+    bool keyed;             /* Drawn over the background, see ASSET_COLOR_KEY */
+} asset_def_t;
+
+typedef struct
+{
+    uint16_t pixels[LOAD_SCRATCH_PIXELS];
+    palette_histogram_t histogram;
+} load_scratch_t;
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static esp_err_t load_sprite(const asset_def_t * def, uint16_t * pixels);
+static uint8_t choose_format(const asset_def_t * def, load_scratch_t * scratch);
+static esp_err_t load_indexed_sprite(const asset_def_t * def, uint8_t bits_per_pixel, void * slot, load_scratch_t * scratch);
+static const uint8_t * encode_runs(const asset_sprite_t * sprite);
+
+/*
+**====================================================================================
+** Private variable declarations
+**====================================================================================
+*/
+
+static const char *TAG = "Assets";
+
+/* Nearly all images have only a few colours, so they are kept indexed. The logo may have more, and
+ * is big enough for 8 bits per pixel to pay for its palette. An image with more colours than that
+ * is kept at 16 bits per pixel, see choose_format(). */
+static const asset_def_t priv_asset_defs[NUMBER_OF_ASSETS] =
+{
+    [ASSET_SNAKE_HEAD]          = { "/images/snake_head",   20,  20, 4, true  },
+    [ASSET_SNAKE_BODY]          = { "/images/snake_body",   20,  20, 4, true  },
+
+    [ASSET_APPLE]               = { "/images/apple",        20,  20, 4, true  },
+    [ASSET_CHERRY]              = { "/images/cherry",       20,  20, 4, true  },
+    [ASSET_GRAPES]              = { "/images/grapes",       20,  20, 4, true  },
+    [ASSET_PINEAPPLE]           = { "/images/pineapple",    20,  20, 4, true  },
+    [ASSET_TOMATO]              = { "/images/tomato",       20,  20, 4, true  },
+    [ASSET_WATERMELON]          = { "/images/watermelon",   20,  20, 4, true  },
+
+    [ASSET_LVL1]                = { "/images/lvl1",        100,  40, 4, false },
+    [ASSET_LVL1_HIGHLIGHTED]    = { "/images/lvl1h",       100,  40, 4, false },
+    [ASSET_LVL2]                = { "/images/lvl2",        100,  40, 4, false },
+    [ASSET_LVL2_HIGHLIGHTED]    = { "/images/lvl2h",       100,  40, 4, false },
+    [ASSET_LVL3]                = { "/images/lvl3",        100,  40, 4, false },
+    [ASSET_LVL3_HIGHLIGHTED]    = { "/images/lvl3h",       100,  40, 4, false },
+    [ASSET_OPTIONS]             = { "/images/options",     100,  40, 4, false },
+    [ASSET_OPTIONS_HIGHLIGHTED] = { "/images/optionsh",    100,  40, 4, false },
+
+    [ASSET_SPEED1]              = { "/images/speed1",      100,  20, 4, false },
+    [ASSET_SPEED2]              = { "/images/speed2",      100,  20, 4, false },
+    [ASSET_SPEED3]              = { "/images/speed3",      100,  20, 4, false },
+
+    [ASSET_ENGINAATOR]          = { "/enginaator",         156,  40, 8, false },
+};
+
+static asset_sprite_t priv_sprites[NUMBER_OF_ASSETS];
+
+static uint8_t priv_run_table[RUN_TABLE_SIZE];
+static uint32_t priv_run_table_used;
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+/* Reads every image from the SD card into one resident atlas. The atlas memory is the sprite pool,
+ * allocated once, so apart from the scratch buffer that is freed again the heap does not change
+ * after this. The images are read twice, first to count their colours and size the pool for the
+ * formats they need. Must be called after sdCard_init(). Nothing touches the SD card for images
+ * after this. */
+void assets_init(void)
+{
+    int64_t total_start = esp_timer_get_time();
+    uint8_t formats[NUMBER_OF_ASSETS];
+    load_scratch_t * scratch;
+
+    scratch = heap_caps_malloc(sizeof(load_scratch_t), LOAD_SCRATCH_PRIMARY_CAPS);
+    if (scratch == NULL)
+    {
+        scratch = heap_caps_malloc(sizeof(load_scratch_t), LOAD_SCRATCH_FALLBACK_CAPS);
+    }
+    assert(scratch);
+    priv_run_table_used = 0u;
+
+    if (sdCard_Open_asset_pack(ASSET_PACK_PATH) != ESP_OK)
+    {
+        ESP_LOGI(TAG, "No usable %s, loading images one file at a time", ASSET_PACK_PATH);
+    }
+
+    for (int ix = 0; ix < NUMBER_OF_ASSETS; ix++)
+    {
+        bool reserved;
+
+        formats[ix] = choose_format(&priv_asset_defs[ix], scratch);
+        reserved = spritePool_reserve(priv_asset_defs[ix].width, priv_asset_defs[ix].height, formats[ix]);
+
+        /* Every size in the table has a pool class in every format. */
+        assert(reserved);
+        (void)reserved;
+    }
+    spritePool_init();
+
+    for (int ix = 0; ix < NUMBER_OF_ASSETS; ix++)
+    {
+        const asset_def_t * def = &priv_asset_defs[ix];
+        asset_sprite_t * sprite = &priv_sprites[ix];
+        uint8_t bits_per_pixel = formats[ix];
+        void * slot = spritePool_alloc(def->width, def->height, bits_per_pixel);
+        uint32_t bytes;
+        esp_err_t ret;
+        int64_t start = esp_timer_get_time();
+
+        /* Every sprite has reserved its slot. */
+        assert(slot);
+
+        sprite->width = def->width;
+        sprite->height = def->height;
+        sprite->bits_per_pixel = bits_per_pixel;
+        sprite->keyed = def->keyed;
+
+        if (bits_per_pixel == 16u)
+        {
+            bytes = def->width * def->height * sizeof(uint16_t);
+            sprite->pixels = slot;
+            sprite->palette = NULL;
+            ret = load_sprite(def, slot);
+        }
+        else
+        {
+            uint32_t palette_bytes = BLIT_PALETTE_ENTRIES(bits_per_pixel) * sizeof(uint16_t);
+
+            bytes = palette_bytes + (BLIT_INDEXED_ROW_BYTES(def->width, bits_per_pixel) * def->height);
+            sprite->palette = slot;
+            sprite->pixels = (uint8_t *)slot + palette_bytes;
+            ret = load_indexed_sprite(def, bits_per_pixel, slot, scratch);
+        }
+
+        if (ret != ESP_OK)
+        {
+            /* Keep going with a black image rather than whatever the slot held before. Indexed ones
+             * use index 1 of an all black palette, as index 0 may be transparent. */
+            ESP_LOGE(TAG, "%s could not be loaded", def->name);
+            memset(slot, 0, bytes);
+            if (sprite->palette != NULL)
+            {
+                memset((void *)sprite->pixels, (bits_per_pixel == 4u) ? 0x11 : 0x01,
+                       bytes - (BLIT_PALETTE_ENTRIES(bits_per_pixel) * sizeof(uint16_t)));
+            }
+        }
+
+        sprite->runs = def->keyed ? encode_runs(sprite) : NULL;
+
+        ESP_LOGI(TAG, "%-24s %5" PRIu32 " bytes in %6" PRId64 " us", def->name, bytes, esp_timer_get_time() - start);
+    }
+
+    sdCard_Close_asset_pack();
+    heap_caps_free(scratch);
+
+    ESP_LOGI(TAG, "Atlas: %d images, %" PRIu32 " bytes, %" PRIu32 " bytes of run tables, loaded in %" PRId64 " ms",
+             NUMBER_OF_ASSETS, spritePool_getTotalBytes(), priv_run_table_used, (esp_timer_get_time() - total_start) / 1000);
+}
+
+
+const asset_sprite_t * assets_get(asset_handle_t handle)
+{
+    assert(handle < NUMBER_OF_ASSETS);
+    return &priv_sprites[handle];
+}
+
+
+uint32_t assets_getTotalBytes(void)
+{
+    return spritePool_getTotalBytes();
+}
+
+
+/* Draws the part of the sprite inside the clip rectangle into a surface held in memory, such as
+ * the frame buffer. Indexed sprites are expanded to RGB565 on the way, and keyed ones with a run
+ * table skip their transparent pixels without reading them. */
+void assets_draw(const blit_surface_t * surface, int x, int y, asset_handle_t handle, const blit_rect_t * clip)
+{
+    const asset_sprite_t * sprite = assets_get(handle);
+
+    if (sprite->runs != NULL)
+    {
+        blit_copyRuns(surface, x, y, sprite->width, sprite->height, sprite->pixels,
+                      sprite->bits_per_pixel, sprite->palette, sprite->runs, clip);
+    }
+    else if (sprite->palette != NULL)
+    {
+        blit_copyIndexed(surface, x, y, sprite->width, sprite->height, sprite->pixels,
+                         sprite->bits_per_pixel, sprite->palette, sprite->keyed, clip);
+    }
+    else if (sprite->keyed)
+    {
+        blit_copyKeyed(surface, x, y, sprite->width, sprite->height, sprite->pixels, ASSET_COLOR_KEY, clip);
+    }
+    else
+    {
+        blit_copy(surface, x, y, sprite->width, sprite->height, sprite->pixels, clip);
+    }
+}
+
+
+/* Looks an image up by its file name on the card, without the directory and the extension, such
+ * as "enginaator". Returns false if there is none. */
+bool assets_find(const char * name, asset_handle_t * handle)
+{
+    for (int ix = 0; ix < NUMBER_OF_ASSETS; ix++)
+    {
+        const char * file_name = strrchr(priv_asset_defs[ix].name, '/');
+
+        if (strcmp((file_name != NULL) ? (file_name + 1) : priv_asset_defs[ix].name, name) == 0)
+        {
+            *handle = (asset_handle_t)ix;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+/* Takes the image from the asset pack if it has it, else from its own file: the precompiled one,
+ * or the BMP on cards that have not been converted. */
+static esp_err_t load_sprite(const asset_def_t * def, uint16_t * pixels)
+{
+    char path[48];
+    esp_err_t ret;
+
+    ret = sdCard_Read_asset_pack_entry(def->name, pixels, def->width, def->height);
+
+    if (ret == ESP_ERR_NOT_FOUND)
+    {
+        snprintf(path, sizeof(path), "%s" ASSET_RGB565_EXTENSION, def->name);
+        ret = sdCard_Read_rgb565_file(path, pixels, def->width, def->height);
+    }
+
+    if (ret == ESP_ERR_NOT_FOUND)
+    {
+        snprintf(path, sizeof(path), "%s.bmp", def->name);
+        ret = sdCard_Read_bmp_file(path, pixels, def->width, def->height);
+    }
+
+    return ret;
+}
+
+
+/* The bits per pixel the image is kept at: those of its definition if they hold all its colours,
+ * else 16. An image that cannot be read keeps its definition's, it is shown black. */
+static uint8_t choose_format(const asset_def_t * def, load_scratch_t * scratch)
+{
+    uint32_t colors;
+    uint32_t entries;
+
+    if (def->bits_per_pixel == 16u)
+    {
+        return 16u;
+    }
+
+    assert(((uint32_t)def->width * def->height) <= LOAD_SCRATCH_PIXELS);
+
+    if (load_sprite(def, scratch->pixels) != ESP_OK)
+    {
+        return def->bits_per_pixel;
+    }
+
+    /* Index 0 of a keyed sprite is the transparent one */
+    colors = palette_countColors(scratch->pixels, def->width, def->height, def->keyed, ASSET_COLOR_KEY, &scratch->histogram);
+    entries = BLIT_PALETTE_ENTRIES(def->bits_per_pixel) - (def->keyed ? 1u : 0u);
+
+    if (colors > entries)
+    {
+        ESP_LOGW(TAG, "%s has more colours than %u bits per pixel hold, it is kept at 16", def->name, def->bits_per_pixel);
+        return 16u;
+    }
+
+    return def->bits_per_pixel;
+}
+
+
+/* Reads the image at full colour and keeps its palette and indices in the slot, the palette first. */
+static esp_err_t load_indexed_sprite(const asset_def_t * def, uint8_t bits_per_pixel, void * slot, load_scratch_t * scratch)
+{
+    uint16_t * palette = slot;
+    uint8_t * indices = (uint8_t *)slot + (BLIT_PALETTE_ENTRIES(bits_per_pixel) * sizeof(uint16_t));
+    uint32_t changed;
+    esp_err_t ret;
+
+    assert(((uint32_t)def->width * def->height) <= LOAD_SCRATCH_PIXELS);
+
+    ret = load_sprite(def, scratch->pixels);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    changed = palette_quantize(scratch->pixels, def->width, def->height, bits_per_pixel, def->keyed,
+                               ASSET_COLOR_KEY, palette, indices, &scratch->histogram);
+
+    /* Only if the image changed since its colours were counted */
+    if (changed > 0u)
+    {
+        ESP_LOGW(TAG, "%s has more colours than %u bits per pixel hold, %" PRIu32 " pixels changed colour",
+                 def->name, bits_per_pixel, changed);
+    }
+
+    return ESP_OK;
+}
+
+
+/* Returns the run table of a keyed sprite, or NULL if the run table memory is full. */
+static const uint8_t * encode_runs(const asset_sprite_t * sprite)
+{
+    uint8_t * runs = &priv_run_table[priv_run_table_used];
+    uint32_t size = blit_encodeRuns(sprite->pixels, sprite->width, sprite->height, sprite->bits_per_pixel,
+                                    ASSET_COLOR_KEY, runs, RUN_TABLE_SIZE - priv_run_table_used);
+
+    if (size == 0u)
+    {
+        ESP_LOGW(TAG, "No room for the run table of a %ux%u sprite, it is drawn pixel by pixel",
+                 sprite->width, sprite->height);
+        return NULL;
+    }
+
+    priv_run_table_used += size;
+    return runs;
+}
@@ -0,0 +1,69 @@
+/*
+ * assets.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_ASSETS_H_
+#define MAIN_ASSETS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "blit.h"
+
+/* Handles of all images the game uses. They are loaded once by assets_init(). */
+typedef enum
+{
+    ASSET_SNAKE_HEAD,
+    ASSET_SNAKE_BODY,
+
+    ASSET_APPLE,
+    ASSET_CHERRY,
+    ASSET_GRAPES,
+    ASSET_PINEAPPLE,
+    ASSET_TOMATO,
+    ASSET_WATERMELON,
+
+    ASSET_LVL1,
+    ASSET_LVL1_HIGHLIGHTED,
+    ASSET_LVL2,
+    ASSET_LVL2_HIGHLIGHTED,
+    ASSET_LVL3,
+    ASSET_LVL3_HIGHLIGHTED,
+    ASSET_OPTIONS,
+    ASSET_OPTIONS_HIGHLIGHTED,
+
+    ASSET_SPEED1,
+    ASSET_SPEED2,
+    ASSET_SPEED3,
+
+    ASSET_ENGINAATOR,
+
+    NUMBER_OF_ASSETS
+} asset_handle_t;
+
+#define ASSET_FIRST_FOOD    ASSET_APPLE
+#define NUMBER_OF_FOODS     (ASSET_WATERMELON - ASSET_APPLE + 1)
+
+/* Pixels of this colour (white) are transparent in keyed sprites. */
+#define ASSET_COLOR_KEY     0xFFFFu
+
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    uint8_t bits_per_pixel;     /* 16 for RGB565 pixels, 4 or 8 for indexed ones */
+    bool keyed;                 /* Pixels of colour ASSET_COLOR_KEY are not drawn, in an indexed sprite index 0 */
+    const void * pixels;        /* RGB565 in the display's byte order, or indices as blit.h describes, row by row from the top */
+    const uint16_t * palette;   /* RGB565 colour of each index, NULL for RGB565 sprites */
+    const uint8_t * runs;       /* Keyed sprites: the opaque spans, see blit_encodeRuns(). NULL if drawn pixel by pixel */
+} asset_sprite_t;
+
+extern void assets_init(void);
+extern const asset_sprite_t * assets_get(asset_handle_t handle);
+extern uint32_t assets_getTotalBytes(void);
+extern void assets_draw(const blit_surface_t * surface, int x, int y, asset_handle_t handle, const blit_rect_t * clip);
+extern bool assets_find(const char * name, asset_handle_t * handle);
+
+#endif /* MAIN_ASSETS_H_ */
@@ -0,0 +1,479 @@
+/*
+ * blit.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdbool.h>
+#include <string.h>
+
+#include "blit.h"
+
+/*
+**====================================================================================
+** Private type definitions
+**====================================================================================
+*/
+
+/* Result of clipping: what to draw, in surface pixels, and where to start reading the source. */
+typedef struct
+{
+    uint16_t * dest;
+    int src_x;
+    int src_y;
+    int src_offset;
+    int width;
+    int height;
+} clipped_t;
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static bool clip_to_surface(const blit_surface_t * dst, int x, int y, int width, int height,
+                            const blit_rect_t * clip, clipped_t * out);
+static void fill_row(uint16_t * dest, int count, uint16_t color);
+static bool is_opaque(const void * src, int width, int x, int y, uint8_t bits_per_pixel, uint16_t key);
+static void draw_span(uint16_t * dest, const void * src, int width, int x, int y, int count,
+                      uint8_t bits_per_pixel, const uint16_t * palette);
+static void expand_row4(uint16_t * restrict dest, const uint8_t * restrict src, int first, int count,
+                        const uint16_t * restrict palette);
+static void expand_row4_keyed(uint16_t * restrict dest, const uint8_t * restrict src, int first, int count,
+                              const uint16_t * restrict palette);
+static void expand_row8(uint16_t * restrict dest, const uint8_t * restrict src, int count, const uint16_t * restrict palette);
+static void expand_row8_keyed(uint16_t * restrict dest, const uint8_t * restrict src, int count,
+                              const uint16_t * restrict palette);
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+void blit_fill(const blit_surface_t * dst, int x, int y, int width, int height, uint16_t color)
+{
+    clipped_t c;
+
+    if (!clip_to_surface(dst, x, y, width, height, NULL, &c))
+    {
+        return;
+    }
+
+    for (int row = 0; row < c.height; row++)
+    {
+        fill_row(c.dest, c.width, color);
+        c.dest += dst->stride;
+    }
+}
+
+
+void blit_copy(const blit_surface_t * dst, int x, int y, int width, int height,
+               const uint16_t * src, const blit_rect_t * clip)
+{
+    clipped_t c;
+
+    if (!clip_to_surface(dst, x, y, width, height, clip, &c))
+    {
+        return;
+    }
+
+    src += c.src_offset;
+
+    /* Whole rows that are contiguous on both sides go in one copy. */
+    if ((c.width == width) && (c.width == dst->stride))
+    {
+        memcpy(c.dest, src, c.width * c.height * sizeof(uint16_t));
+        return;
+    }
+
+    for (int row = 0; row < c.height; row++)
+    {
+        memcpy(c.dest, src, c.width * sizeof(uint16_t));
+        c.dest += dst->stride;
+        src += width;
+    }
+}
+
+
+/* Like blit_copy(), but source pixels equal to key are left out. */
+void blit_copyKeyed(const blit_surface_t * dst, int x, int y, int width, int height,
+                    const uint16_t * src, uint16_t key, const blit_rect_t * clip)
+{
+    clipped_t c;
+
+    if (!clip_to_surface(dst, x, y, width, height, clip, &c))
+    {
+        return;
+    }
+
+    src += c.src_offset;
+
+    for (int row = 0; row < c.height; row++)
+    {
+        uint16_t * restrict out = c.dest;
+        const uint16_t * restrict in = src;
+
+        /* A select instead of a branch, so the loop has no data dependent jumps. */
+        for (int col = 0; col < c.width; col++)
+        {
+            out[col] = (in[col] == key) ? out[col] : in[col];
+        }
+
+        c.dest += dst->stride;
+        src += width;
+    }
+}
+
+
+/* Like blit_copy(), but every pixel is looked up in the palette on the way, see BLIT_INDEXED_ROW_BYTES(). */
+void blit_copyIndexed(const blit_surface_t * dst, int x, int y, int width, int height,
+                      const uint8_t * src, uint8_t bits_per_pixel, const uint16_t * palette, bool keyed,
+                      const blit_rect_t * clip)
+{
+    uint32_t src_stride = BLIT_INDEXED_ROW_BYTES((uint32_t)width, bits_per_pixel);
+    clipped_t c;
+
+    if (!clip_to_surface(dst, x, y, width, height, clip, &c))
+    {
+        return;
+    }
+
+    src += c.src_y * src_stride;
+
+    for (int row = 0; row < c.height; row++)
+    {
+        if (bits_per_pixel == 4u)
+        {
+            if (keyed)
+            {
+                expand_row4_keyed(c.dest, src, c.src_x, c.width, palette);
+            }
+            else
+            {
+                expand_row4(c.dest, src, c.src_x, c.width, palette);
+            }
+        }
+        else
+        {
+            if (keyed)
+            {
+                expand_row8_keyed(c.dest, &src[c.src_x], c.width, palette);
+            }
+            else
+            {
+                expand_row8(c.dest, &src[c.src_x], c.width, palette);
+            }
+        }
+
+        c.dest += dst->stride;
+        src += src_stride;
+    }
+}
+
+
+/* Writes the run table of a keyed bitmap to runs, see BLIT_RUNS_MAX_WIDTH. Transparent pixels are
+ * those equal to key in an RGB565 bitmap (16 bits per pixel) and index 0 in an indexed one. Returns
+ * the size of the table, or 0 if it needs more than capacity bytes or the bitmap is too wide. */
+uint32_t blit_encodeRuns(const void * src, int width, int height, uint8_t bits_per_pixel, uint16_t key,
+                         uint8_t * runs, uint32_t capacity)
+{
+    uint32_t used = 0u;
+
+    if (width > BLIT_RUNS_MAX_WIDTH)
+    {
+        return 0u;
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        uint32_t count_pos = used;
+        uint8_t count = 0u;
+        int x = 0;
+
+        if (used >= capacity)
+        {
+            return 0u;
+        }
+        used++;
+
+        while (x < width)
+        {
+            int skip_start = x;
+            int draw_start;
+
+            while ((x < width) && !is_opaque(src, width, x, y, bits_per_pixel, key))
+            {
+                x++;
+            }
+            if (x == width)
+            {
+                break;
+            }
+
+            draw_start = x;
+            while ((x < width) && is_opaque(src, width, x, y, bits_per_pixel, key))
+            {
+                x++;
+            }
+
+            if ((used + 2u) > capacity)
+            {
+                return 0u;
+            }
+            runs[used++] = (uint8_t)(draw_start - skip_start);
+            runs[used++] = (uint8_t)(x - draw_start);
+            count++;
+        }
+
+        runs[count_pos] = count;
+    }
+
+    return used;
+}
+
+
+/* Like blit_copyKeyed() and the keyed blit_copyIndexed(), but the transparent pixels come from the
+ * run table and are never looked at. Opaque spans of RGB565 bitmaps are copied with memcpy(). */
+void blit_copyRuns(const blit_surface_t * dst, int x, int y, int width, int height,
+                   const void * src, uint8_t bits_per_pixel, const uint16_t * palette, const uint8_t * runs,
+                   const blit_rect_t * clip)
+{
+    clipped_t c;
+    int visible_end;
+
+    if (!clip_to_surface(dst, x, y, width, height, clip, &c))
+    {
+        return;
+    }
+
+    visible_end = c.src_x + c.width;
+
+    /* Rows above the clip only need their runs stepped over. */
+    for (int row = 0; row < c.src_y; row++)
+    {
+        runs += 1u + (2u * runs[0]);
+    }
+
+    for (int row = 0; row < c.height; row++)
+    {
+        uint8_t count = *runs++;
+        int pos = 0;
+
+        for (uint8_t run = 0u; run < count; run++)
+        {
+            int start = pos + runs[2u * run];
+            int end = start + runs[(2u * run) + 1u];
+
+            pos = end;
+            if (start >= visible_end)
+            {
+                break;
+            }
+            if (start < c.src_x)
+            {
+                start = c.src_x;
+            }
+            if (end > visible_end)
+            {
+                end = visible_end;
+            }
+
+            if (start < end)
+            {
+                draw_span(&c.dest[start - c.src_x], src, width, start, c.src_y + row, end - start, bits_per_pixel, palette);
+            }
+        }
+
+        runs += 2u * count;
+        c.dest += dst->stride;
+    }
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+static bool clip_to_surface(const blit_surface_t * dst, int x, int y, int width, int height,
+                            const blit_rect_t * clip, clipped_t * out)
+{
+    int x0 = x;
+    int y0 = y;
+    int x1 = x + width;
+    int y1 = y + height;
+
+    if (clip != NULL)
+    {
+        if (clip->x > x0) x0 = clip->x;
+        if (clip->y > y0) y0 = clip->y;
+        if ((clip->x + clip->width) < x1) x1 = clip->x + clip->width;
+        if ((clip->y + clip->height) < y1) y1 = clip->y + clip->height;
+    }
+
+    if (dst->x > x0) x0 = dst->x;
+    if (dst->y > y0) y0 = dst->y;
+    if ((dst->x + dst->width) < x1) x1 = dst->x + dst->width;
+    if ((dst->y + dst->height) < y1) y1 = dst->y + dst->height;
+
+    if ((x0 >= x1) || (y0 >= y1))
+    {
+        return false;
+    }
+
+    out->dest = dst->pixels + ((y0 - dst->y) * dst->stride) + (x0 - dst->x);
+    out->src_x = x0 - x;
+    out->src_y = y0 - y;
+    out->src_offset = (out->src_y * width) + out->src_x;
+    out->width = x1 - x0;
+    out->height = y1 - y0;
+
+    return true;
+}
+
+
+/* Fills two pixels per 32 bit store once the destination is word aligned. */
+static void fill_row(uint16_t * dest, int count, uint16_t color)
+{
+    uint32_t pair = ((uint32_t)color << 16) | color;
+    uint32_t * dest32;
+
+    if ((count > 0) && (((uintptr_t)dest & 0x2u) != 0u))
+    {
+        *dest++ = color;
+        count--;
+    }
+
+    dest32 = (uint32_t *)dest;
+    for (int ix = 0; ix < (count >> 1); ix++)
+    {
+        dest32[ix] = pair;
+    }
+
+    if (count & 1)
+    {
+        dest[count - 1] = color;
+    }
+}
+
+
+/* Pixels first to first + count - 1 of a 4 bpp row, a whole byte at a time between the ends. */
+static void expand_row4(uint16_t * restrict dest, const uint8_t * restrict src, int first, int count,
+                        const uint16_t * restrict palette)
+{
+    src += first >> 1;
+
+    if ((first & 1) && (count > 0))
+    {
+        *dest++ = palette[*src++ & 0x0Fu];
+        count--;
+    }
+
+    for (int pair = 0; pair < (count >> 1); pair++)
+    {
+        uint8_t both = src[pair];
+
+        dest[2 * pair] = palette[both >> 4];
+        dest[(2 * pair) + 1] = palette[both & 0x0Fu];
+    }
+
+    if (count & 1)
+    {
+        dest[count - 1] = palette[src[count >> 1] >> 4];
+    }
+}
+
+
+static void expand_row4_keyed(uint16_t * restrict dest, const uint8_t * restrict src, int first, int count,
+                              const uint16_t * restrict palette)
+{
+    src += first >> 1;
+
+    if ((first & 1) && (count > 0))
+    {
+        uint8_t index = *src++ & 0x0Fu;
+
+        *dest = (index == 0u) ? *dest : palette[index];
+        dest++;
+        count--;
+    }
+
+    for (int pair = 0; pair < (count >> 1); pair++)
+    {
+        uint8_t left = src[pair] >> 4;
+        uint8_t right = src[pair] & 0x0Fu;
+
+        dest[2 * pair] = (left == 0u) ? dest[2 * pair] : palette[left];
+        dest[(2 * pair) + 1] = (right == 0u) ? dest[(2 * pair) + 1] : palette[right];
+    }
+
+    if (count & 1)
+    {
+        uint8_t index = src[count >> 1] >> 4;
+
+        dest[count - 1] = (index == 0u) ? dest[count - 1] : palette[index];
+    }
+}
+
+
+static void expand_row8(uint16_t * restrict dest, const uint8_t * restrict src, int count, const uint16_t * restrict palette)
+{
+    for (int col = 0; col < count; col++)
+    {
+        dest[col] = palette[src[col]];
+    }
+}
+
+
+static void expand_row8_keyed(uint16_t * restrict dest, const uint8_t * restrict src, int count,
+                              const uint16_t * restrict palette)
+{
+    for (int col = 0; col < count; col++)
+    {
+        dest[col] = (src[col] == 0u) ? dest[col] : palette[src[col]];
+    }
+}
+
+
+static bool is_opaque(const void * src, int width, int x, int y, uint8_t bits_per_pixel, uint16_t key)
+{
+    const uint8_t * row = (const uint8_t *)src + (y * BLIT_INDEXED_ROW_BYTES((uint32_t)width, bits_per_pixel));
+
+    switch (bits_per_pixel)
+    {
+    case 4u:
+        return ((row[x >> 1] >> ((~x & 1) << 2)) & 0x0Fu) != 0u;
+    case 8u:
+        return row[x] != 0u;
+    default:
+        return ((const uint16_t *)src)[(y * width) + x] != key;
+    }
+}
+
+
+/* count pixels of row y from column x on. */
+static void draw_span(uint16_t * dest, const void * src, int width, int x, int y, int count,
+                      uint8_t bits_per_pixel, const uint16_t * palette)
+{
+    const uint8_t * row = (const uint8_t *)src + (y * BLIT_INDEXED_ROW_BYTES((uint32_t)width, bits_per_pixel));
+
+    switch (bits_per_pixel)
+    {
+    case 4u:
+        expand_row4(dest, row, x, count, palette);
+        break;
+    case 8u:
+        expand_row8(dest, &row[x], count, palette);
+        break;
+    default:
+        memcpy(dest, &((const uint16_t *)src)[(y * width) + x], count * sizeof(uint16_t));
+        break;
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * blit.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_BLIT_H_
+#define MAIN_BLIT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* A block of pixels that blits draw into: the frame buffer or a transfer strip. Coordinates passed
+ * to the kernels are screen coordinates; x and y say where the surface's first pixel is on screen. */
+typedef struct
+{
+    uint16_t * pixels;
+    int16_t x;
+    int16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint16_t stride;        /* In pixels */
+} blit_surface_t;
+
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+    int16_t width;
+    int16_t height;
+} blit_rect_t;
+
+/* Indexed bitmaps hold one byte per pixel at 8 bpp, or two pixels per byte at 4 bpp with the left one
+ * in the high nibble. Every row starts on a new byte. The palette holds the RGB565 colour of each
+ * index, and in keyed bitmaps index 0 is transparent. */
+#define BLIT_INDEXED_ROW_BYTES(width, bits_per_pixel)   ((((width) * (bits_per_pixel)) + 7u) / 8u)
+#define BLIT_PALETTE_ENTRIES(bits_per_pixel)            (1u << (bits_per_pixel))
+
+/* Run tables list the opaque spans of a keyed bitmap, so the blitter can jump over its transparent
+ * pixels instead of testing each one. Every row has a count byte followed by that many pairs of
+ * bytes: the transparent pixels to skip, then the opaque pixels to draw. What follows the last
+ * pair of a row is transparent. Bitmaps can be at most 255 pixels wide. */
+#define BLIT_RUNS_MAX_WIDTH     255
+
+/* All kernels clip once against the surface and the optional clip rectangle, then run row by row.
+ * Source bitmaps are row-major, width pixels per row, as loaded by sdCard_Read_bmp_file(). */
+extern void blit_fill(const blit_surface_t * dst, int x, int y, int width, int height, uint16_t color);
+extern void blit_copy(const blit_surface_t * dst, int x, int y, int width, int height,
+                      const uint16_t * src, const blit_rect_t * clip);
+extern void blit_copyKeyed(const blit_surface_t * dst, int x, int y, int width, int height,
+                           const uint16_t * src, uint16_t key, const blit_rect_t * clip);
+extern void blit_copyIndexed(const blit_surface_t * dst, int x, int y, int width, int height,
+                             const uint8_t * src, uint8_t bits_per_pixel, const uint16_t * palette, bool keyed,
+                             const blit_rect_t * clip);
+extern uint32_t blit_encodeRuns(const void * src, int width, int height, uint8_t bits_per_pixel, uint16_t key,
+                                uint8_t * runs, uint32_t capacity);
+extern void blit_copyRuns(const blit_surface_t * dst, int x, int y, int width, int height,
+                          const void * src, uint8_t bits_per_pixel, const uint16_t * palette, const uint8_t * runs,
+                          const blit_rect_t * clip);
+
+#endif /* MAIN_BLIT_H_ */
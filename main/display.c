@@ -21,6 +21,7 @@
 #include "driver/gpio.h"
 
 #include "display.h"
+#include "spiBus.h"
 
 /*
 **====================================================================================
@@ -28,13 +29,27 @@
 **====================================================================================
 */
 
-#define LCD_HOST    SPI2_HOST
+#define LCD_HOST    SPI_BUS_HOST
 
 #define PIN_NUM_DC         7
 #define PIN_NUM_RST        15
 #define PIN_NUM_DISPLAY_CS 6
 #define PIN_NUM_BCKL       2
 
+#define DIRTY_COLUMNS      (DISPLAY_WIDTH / DISPLAY_DIRTY_CELL_WIDTH)
+#define DIRTY_ROWS         (DISPLAY_HEIGHT / DISPLAY_DIRTY_CELL_HEIGHT)
+#define DIRTY_ROW_ALL      ((1u << DIRTY_COLUMNS) - 1u)
+
+/* Pixels go out of a ring in DMA capable memory. Regions are packed into it back to back, so any
+ * number of small ones can be in flight while the CPU renders the next. It holds two strips of the
+ * largest size, so one can be filled while the other is streamed. */
+#define PIXEL_RING_SIZE    (2 * DISPLAY_MAX_TRANSFER_SIZE)
+/* Regions in flight at once. Each needs up to REGION_TRANSACTIONS queued transactions. */
+#define REGION_RING_SIZE   16
+/* CASET + data, RASET + data, RAMWR, pixel data */
+#define REGION_TRANSACTIONS 6
+#define SPI_QUEUE_SIZE     (REGION_RING_SIZE * REGION_TRANSACTIONS)
+
 /*
 **====================================================================================
 ** Private type definitions
@@ -48,6 +63,13 @@ typedef struct
     uint8_t databytes; //No of data in data; bit 7 = delay after set; 0xFF = end of cmds.
 } lcd_init_cmd_t;
 
+typedef struct
+{
+    spi_transaction_t trans[REGION_TRANSACTIONS];   //Built from the templates once, only the addresses and the pixels change
+    uint32_t fence;                                 //Sequence number of the region's last transaction
+    uint32_t pixel_end;                             //Where its pixels end in the ring, as a running byte count
+} region_slot_t;
+
 /*
 **====================================================================================
 ** Private function forward declaration
@@ -58,8 +80,15 @@ static void lcd_spi_pre_transfer_callback(spi_transaction_t *t);
 static void lcd_cmd(spi_device_handle_t spi, const uint8_t cmd, bool keep_cs_active);
 static void lcd_data(spi_device_handle_t spi, const uint8_t *data, int len);
 static void lcd_init(spi_device_handle_t spi);
-static void send_display_data(spi_device_handle_t spi, int xPos, int yPos, int width, int height, uint16_t *linedata, bool isBufferConstant);
+static void init_region_slot(region_slot_t *slot);
+static void send_display_data(spi_device_handle_t spi, region_slot_t *slot, int xPos, int yPos, int width, int height, uint16_t *linedata);
 static void wait_display_data_finish(spi_device_handle_t spi);
+static void wait_fence(spi_device_handle_t spi, uint32_t fence);
+static uint16_t *reserve_pixels(uint32_t bytes);
+static void reclaim_oldest_region(void);
+static void send_buffer_region(const uint16_t *src, int src_stride, int xPos, int yPos, int width, int height);
+static void render_region(display_region_renderer_t render, void *ctx, int xPos, int yPos, int width, int height);
+static void copy_from_frame_buffer(uint16_t *dest, int x, int y, int width, int height, void *ctx);
 
 
 /*
@@ -104,7 +133,30 @@ DRAM_ATTR static const lcd_init_cmd_t st_init_cmds[]=
 };
 
 static spi_device_handle_t priv_spi_handle;
-static uint16_t *line_data;
+
+static uint8_t *priv_pixel_ring;
+/* Running byte counts: reserved so far, and the end of the pixels of the last finished region */
+static uint32_t priv_pixel_head = 0u;
+static uint32_t priv_pixel_tail = 0u;
+static uint16_t *priv_acquired_pixels = NULL;
+
+static region_slot_t priv_regions[REGION_RING_SIZE];
+static int priv_oldest_region = 0;
+static int priv_regions_in_flight = 0;
+
+/* The address window the panel will have once everything queued has been sent. CASET and RASET
+ * are left out when they would not change it. */
+static int priv_window_x0 = -1;
+static int priv_window_x1 = -1;
+static int priv_window_y0 = -1;
+static int priv_window_y1 = -1;
+
+/* Transactions complete in the order they were queued, so counting them is enough for fences. */
+static uint32_t priv_queued_count = 0u;
+static uint32_t priv_completed_count = 0u;
+
+/* One bit per dirty cell, bit 0 is the leftmost column. */
+static uint16_t priv_dirty_rows[DIRTY_ROWS];
 
 
 /*
@@ -122,13 +174,13 @@ void display_init(void)
         .clock_speed_hz=40*1000*1000,           //Clock out at 40 MHz
         .mode=0,                                //SPI mode 0
         .spics_io_num=PIN_NUM_DISPLAY_CS,       //CS pin
-        .queue_size=12,                         //We want to be able to queue 12 transactions at a time
+        .queue_size=SPI_QUEUE_SIZE,             //Every region in the ring can be queued at once
         .pre_cb=lcd_spi_pre_transfer_callback,  //Specify pre-transfer callback to handle D/C line
     };
 
     printf("Initializing SPI bus... \n");
 
-    //Attach the LCD to the SPI bus that was initialized in main.c
+    //Attach the LCD to the SPI bus that was initialized in spiBus.c
     ret=spi_bus_add_device(LCD_HOST, &devcfg, &priv_spi_handle);
     ESP_ERROR_CHECK(ret);
 
@@ -137,38 +189,180 @@ void display_init(void)
     //Initialize the LCD
     lcd_init(priv_spi_handle);
 
-    /* This buffer is used by the fill Rectangle function. */
-    line_data = heap_caps_malloc(DISPLAY_MAX_TRANSFER_SIZE, MALLOC_CAP_DMA);
+    /* All pixel data goes to the display through the ring, the callers' buffers are never read by the DMA. */
+    priv_pixel_ring = heap_caps_malloc(PIXEL_RING_SIZE, MALLOC_CAP_DMA);
+    assert(priv_pixel_ring != NULL);
+
+    for (int ix = 0; ix < REGION_RING_SIZE; ix++)
+    {
+        init_region_slot(&priv_regions[ix]);
+    }
 }
 
 
+/* Sends the whole buffer. Returns as soon as the last part is queued, buf can be drawn into right away. */
 void display_drawScreenBuffer(uint16_t *buf)
 {
-    wait_display_data_finish(priv_spi_handle);
-    send_display_data(priv_spi_handle, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, buf, false);
+    display_markAllDirty();
+    display_present(buf);
+}
+
+
+/* Records that the given area of the frame buffer has changed. The area is rounded out to whole cells. */
+void display_markDirty(int x, int y, int width, int height)
+{
+    int first_col, last_col, first_row, last_row;
+    uint16_t mask;
+
+    /* Clip to the screen */
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    width = MIN(width, (int)DISPLAY_WIDTH - x);
+    height = MIN(height, (int)DISPLAY_HEIGHT - y);
+
+    if ((width <= 0) || (height <= 0))
+    {
+        return;
+    }
+
+    first_col = x / DISPLAY_DIRTY_CELL_WIDTH;
+    last_col = (x + width - 1) / DISPLAY_DIRTY_CELL_WIDTH;
+    first_row = y / DISPLAY_DIRTY_CELL_HEIGHT;
+    last_row = (y + height - 1) / DISPLAY_DIRTY_CELL_HEIGHT;
+
+    mask = (uint16_t)(((1u << (last_col + 1)) - 1u) & ~((1u << first_col) - 1u));
+
+    for (int row = first_row; row <= last_row; row++)
+    {
+        priv_dirty_rows[row] |= mask;
+    }
+}
+
+
+void display_markAllDirty(void)
+{
+    for (uint32_t row = 0u; row < DIRTY_ROWS; row++)
+    {
+        priv_dirty_rows[row] = DIRTY_ROW_ALL;
+    }
+}
+
+
+/* Sends only the dirty cells of the frame buffer to the display.
+ *
+ * The regions are copied into the pixel ring and queued without waiting for them to finish.
+ * It only blocks while the ring is full, so the next frame can be drawn into buf
+ * while the last regions are streamed out. */
+void display_present(uint16_t *buf)
+{
+    display_presentRegions(copy_from_frame_buffer, buf);
+}
+
+
+/* Sends the dirty cells, asking render to produce the pixels of each region one strip at a time.
+ * Horizontally adjacent cells are merged into one span and identical spans on the following cell
+ * rows are merged into one region, so every region costs one column/page address window. */
+void display_presentRegions(display_region_renderer_t render, void *ctx)
+{
+    for (uint32_t row = 0u; row < DIRTY_ROWS; row++)
+    {
+        while (priv_dirty_rows[row] != 0u)
+        {
+            uint32_t bits = priv_dirty_rows[row];
+            int first_col = __builtin_ctz(bits);
+            int col_count = __builtin_ctz(~(bits >> first_col));
+            uint16_t run_mask = (uint16_t)(((1u << col_count) - 1u) << first_col);
+            uint32_t row_count = 1u;
+
+            priv_dirty_rows[row] &= ~run_mask;
+
+            while (((row + row_count) < DIRTY_ROWS) && ((priv_dirty_rows[row + row_count] & run_mask) == run_mask))
+            {
+                priv_dirty_rows[row + row_count] &= ~run_mask;
+                row_count++;
+            }
+
+            render_region(render, ctx,
+                          first_col * DISPLAY_DIRTY_CELL_WIDTH,
+                          row * DISPLAY_DIRTY_CELL_HEIGHT,
+                          col_count * DISPLAY_DIRTY_CELL_WIDTH,
+                          row_count * DISPLAY_DIRTY_CELL_HEIGHT);
+        }
+    }
 }
 
 
+/* Copies the bitmap into the pixel ring, bmp_buf may be reused as soon as this returns. */
 void display_drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *bmp_buf)
 {
-    wait_display_data_finish(priv_spi_handle);
-    send_display_data(priv_spi_handle, x, y, width, height, bmp_buf, false);
+    send_buffer_region(bmp_buf, width, x, y, width, height);
 }
 
 /* Draws a rectangle directly on the display at the given coordinates. */
 void display_fillRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color)
 {
-	uint16_t buf_size = MIN(DISPLAY_MAX_TRANSFER_SIZE, height*width*sizeof(uint16_t));
+    int lines_per_chunk;
 
-	wait_display_data_finish(priv_spi_handle);
-    assert(line_data != NULL);
+    if ((width == 0u) || (height == 0u))
+    {
+        return;
+    }
 
-    for (int x = 0; x < (buf_size / 2); x++)
+    lines_per_chunk = DISPLAY_MAX_TRANSFER_SIZE / (width * sizeof(uint16_t));
+    for (int line = 0; line < height; line += lines_per_chunk)
     {
-    	line_data[x] = color;
+        int lines = MIN(lines_per_chunk, height - line);
+        uint16_t *strip = display_acquireStrip(width, lines);
+
+        for (int ix = 0; ix < (lines * width); ix++)
+        {
+            strip[ix] = color;
+        }
+
+        display_presentStrip(strip, x, y + line, width, lines);
     }
+}
+
+
+/* Returns room for width x height pixels, at most DISPLAY_MAX_TRANSFER_SIZE bytes, to render into.
+ * Blocks only while the DMA still needs that part of the pixel ring. Must be handed back with
+ * display_presentStrip() for an area of the same size. */
+uint16_t *display_acquireStrip(int width, int height)
+{
+    uint32_t bytes = (uint32_t)width * height * sizeof(uint16_t);
+
+    assert((priv_acquired_pixels == NULL) && (bytes <= DISPLAY_MAX_TRANSFER_SIZE));
+    priv_acquired_pixels = reserve_pixels(bytes);
+    return priv_acquired_pixels;
+}
+
+
+/* Queues the acquired strip for the given area of the display and returns without waiting. */
+void display_presentStrip(uint16_t *strip, int x, int y, int width, int height)
+{
+    region_slot_t *slot;
+
+    assert((priv_acquired_pixels != NULL) && (priv_acquired_pixels == strip));
+
+    if (priv_regions_in_flight == REGION_RING_SIZE)
+    {
+        reclaim_oldest_region();
+    }
+
+    slot = &priv_regions[(priv_oldest_region + priv_regions_in_flight) % REGION_RING_SIZE];
+    send_display_data(priv_spi_handle, slot, x, y, width, height, strip);
+    slot->fence = priv_queued_count;
+    slot->pixel_end = priv_pixel_head;
+    priv_regions_in_flight++;
+
+    priv_acquired_pixels = NULL;
+}
 
-	send_display_data(priv_spi_handle, x, y, width, height, line_data, true);
+
+/* The one fence per frame: waits for everything queued so far. */
+void display_waitIdle(void)
+{
+    wait_display_data_finish(priv_spi_handle);
 }
 
 
@@ -181,7 +375,7 @@ void display_fillRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t heig
 //set the D/C line to the value indicated in the user field.
 static void lcd_spi_pre_transfer_callback(spi_transaction_t *t)
 {
-    int dc=(int)t->user;
+    int dc=(int)(intptr_t)t->user;
     gpio_set_level(PIN_NUM_DC, dc);
 }
 
@@ -247,6 +441,7 @@ static void lcd_cmd(spi_device_handle_t spi, const uint8_t cmd, bool keep_cs_act
     }
     ret=spi_device_polling_transmit(spi, &t);  //Transmit!
     assert(ret==ESP_OK);            //Should have had no issues.
+    (void)ret;                      //Unused when asserts are compiled out
 }
 
 
@@ -268,104 +463,241 @@ static void lcd_data(spi_device_handle_t spi, const uint8_t *data, int len)
     t.user=(void*)1;                //D/C needs to be set to 1
     ret=spi_device_polling_transmit(spi, &t);  //Transmit!
     assert(ret==ESP_OK);            //Should have had no issues.
+    (void)ret;                      //Unused when asserts are compiled out
+}
+
+/* Fills in the parts of a region's transactions that never change: the commands, the lengths and
+ * the D/C levels. */
+static void init_region_slot(region_slot_t *slot)
+{
+    spi_transaction_t *trans = slot->trans;
+
+    memset(trans, 0, sizeof(slot->trans));
+
+    trans[0].flags=SPI_TRANS_USE_TXDATA;
+    trans[0].tx_data[0]=0x2A;           	//Column Address Set
+    trans[0].length = 8;
+    trans[0].user=(void*)0;
+
+    trans[1].flags=SPI_TRANS_USE_TXDATA;	//Start and end column
+    trans[1].length = 8*4;
+    trans[1].user=(void*)1;
+
+    trans[2].flags=SPI_TRANS_USE_TXDATA;
+    trans[2].tx_data[0]=0x2B;           	//Page address set
+    trans[2].length = 8;
+    trans[2].user=(void*)0;
+
+    trans[3].flags=SPI_TRANS_USE_TXDATA;	//Start and end page
+    trans[3].length = 8*4;
+    trans[3].user=(void*)1;
+
+    trans[4].flags=SPI_TRANS_USE_TXDATA;
+    trans[4].tx_data[0]=0x2C;           	//memory write
+    trans[4].length = 8;
+    trans[4].user=(void*)0;
+
+    trans[5].user =(void*)1;            	//The pixel data, from the ring
 }
 
-uint8_t priv_number_of_transfers = 0u;
 
-/* Updates the whole screen */
-static void send_display_data(spi_device_handle_t spi, int xPos, int yPos, int width, int height, uint16_t *linedata, bool isBufferConstant)
+/* Queues the address window and the pixel data of one area. The slot must stay untouched until
+ * these transactions have completed, linedata must not be larger than DISPLAY_MAX_TRANSFER_SIZE. */
+static void send_display_data(spi_device_handle_t spi, region_slot_t *slot, int xPos, int yPos, int width, int height, uint16_t *linedata)
 {
     esp_err_t ret;
+    spi_transaction_t *trans = slot->trans;
     int total_size_bytes = width * height * 2;
-    int chunk_ix = 5;
-    uint16_t * line_ptr;
-    int curr_transfer_size;
-
-    //Transaction descriptors. Declared static so they're not allocated on the stack; we need this memory even when this
-    //function is finished because the SPI driver needs access to it even while we're already calculating the next line.
-    static spi_transaction_t trans[12];
+    int queued = 0;
 
 	uint16_t end_column = (xPos + width) - 1u;
     uint16_t end_row = (yPos + height) - 1u;
 
+    assert(total_size_bytes <= DISPLAY_MAX_TRANSFER_SIZE);
+
     end_column = MIN(end_column, DISPLAY_WIDTH);
     end_row = MIN(end_row, DISPLAY_HEIGHT);
 
-    //In theory, it's better to initialize trans and data only once and hang on to the initialized
-    //variables. We allocate them on the stack, so we need to re-init them each call.
-    for (int ix = 0; ix < 12; ix++)
-    {
-        memset(&trans[ix], 0, sizeof(spi_transaction_t));
-        trans[ix].flags=SPI_TRANS_USE_TXDATA;
-    }
-
-    trans[0].tx_data[0]=0x2A;           	//Column Address Set
-    trans[0].length = 8;
-    trans[0].user=(void*)0;
-
     trans[1].tx_data[0]=xPos >> 8;      	//Start Col High
     trans[1].tx_data[1]=xPos & 0xffu;   	//Start Col Low
     trans[1].tx_data[2]=end_column >> 8;	//End Col High
     trans[1].tx_data[3]=end_column & 0xff;	//End Col Low
-    trans[1].length = 8*4;
-    trans[1].user=(void*)1;
-
-    trans[2].tx_data[0]=0x2B;           	//Page address set
-    trans[2].length = 8;
-    trans[2].user=(void*)0;
 
     trans[3].tx_data[0]=yPos >> 8;        	//Start page high
     trans[3].tx_data[1]=yPos & 0xff;      	//start page low
     trans[3].tx_data[2]=end_row >> 8;    	//end page high
     trans[3].tx_data[3]=end_row & 0xff;  	//end page low
-    trans[3].length = 8*4;
-    trans[3].user=(void*)1;
 
-    trans[4].tx_data[0]=0x2C;           	//memory write
-    trans[4].length = 8;
-    trans[4].user=(void*)0;
+    trans[5].tx_buffer = linedata;        	//finally send the line data
+    trans[5].length=total_size_bytes * 8;  	//Data length, in bits
+
+    //Queue all transactions, the address window only where it changes.
+    for (int ix = 0; ix < REGION_TRANSACTIONS; ix++)
+    {
+        if (((ix < 2) && (xPos == priv_window_x0) && (end_column == priv_window_x1)) ||
+            ((ix >= 2) && (ix < 4) && (yPos == priv_window_y0) && (end_row == priv_window_y1)))
+        {
+            continue;
+        }
+
+        ret=spi_device_queue_trans(spi, &trans[ix], portMAX_DELAY);
+        assert(ret==ESP_OK);
+        (void)ret;
+        queued++;
+    }
+
+    priv_window_x0 = xPos;
+    priv_window_x1 = end_column;
+    priv_window_y0 = yPos;
+    priv_window_y1 = end_row;
+
+    priv_queued_count += queued;
+}
+
+
+/* Reserves room in the pixel ring, waiting for the oldest regions to finish while it is full. A
+ * region never wraps around the end of the ring, it starts over at the beginning instead. */
+static uint16_t *reserve_pixels(uint32_t bytes)
+{
+    uint32_t offset = priv_pixel_head % PIXEL_RING_SIZE;
+
+    bytes = (bytes + 3u) & ~3u;             //Keeps every region word aligned for the DMA
+
+    if ((offset + bytes) > PIXEL_RING_SIZE)
+    {
+        priv_pixel_head += PIXEL_RING_SIZE - offset;
+        offset = 0u;
+    }
+
+    while ((priv_pixel_head + bytes - priv_pixel_tail) > PIXEL_RING_SIZE)
+    {
+        if (priv_regions_in_flight == 0)
+        {
+            //Only the skipped end of the ring is left, nothing reads it
+            priv_pixel_tail = priv_pixel_head;
+            break;
+        }
+
+        reclaim_oldest_region();
+    }
+
+    priv_pixel_head += bytes;
+
+    return (uint16_t *)&priv_pixel_ring[offset];
+}
+
+
+static void reclaim_oldest_region(void)
+{
+    region_slot_t *slot = &priv_regions[priv_oldest_region];
+
+    wait_fence(priv_spi_handle, slot->fence);
+    priv_pixel_tail = slot->pixel_end;
+    priv_oldest_region = (priv_oldest_region + 1) % REGION_RING_SIZE;
+    priv_regions_in_flight--;
+}
+
+
+/* Sends a rectangle of pixels, src points at its top left pixel and src_stride is the width of the
+ * buffer it lives in. The rectangle is gathered into the pixel ring, as many lines at a time as
+ * fit, so src is free again when this returns. */
+static void send_buffer_region(const uint16_t *src, int src_stride, int xPos, int yPos, int width, int height)
+{
+    int lines_per_chunk;
+
+    /* A rectangle clipped away to nothing */
+    if ((width <= 0) || (height <= 0))
+    {
+        return;
+    }
+
+    lines_per_chunk = DISPLAY_MAX_TRANSFER_SIZE / (width * sizeof(uint16_t));
+    for (int line = 0; line < height; line += lines_per_chunk)
+    {
+        int lines = MIN(lines_per_chunk, height - line);
+        uint16_t *strip = display_acquireStrip(width, lines);
+        uint16_t *dest = strip;
+
+        if (src_stride == width)
+        {
+            memcpy(dest, src, lines * width * sizeof(uint16_t));
+            src += lines * width;
+        }
+        else
+        {
+            for (int y = 0; y < lines; y++)
+            {
+                memcpy(dest, src, width * sizeof(uint16_t));
+                dest += width;
+                src += src_stride;
+            }
+        }
+
+        display_presentStrip(strip, xPos, yPos + line, width, lines);
+    }
+}
+
 
-    line_ptr = linedata;
+/* Produces a region strip by strip. Each strip is queued as soon as it is rendered, while the next one is rendered into the ring behind it. */
+static void render_region(display_region_renderer_t render, void *ctx, int xPos, int yPos, int width, int height)
+{
+    int lines_per_chunk;
+
+    /* A rectangle clipped away to nothing */
+    if ((width <= 0) || (height <= 0))
+    {
+        return;
+    }
 
-    while(total_size_bytes > 0)
+    lines_per_chunk = DISPLAY_MAX_TRANSFER_SIZE / (width * sizeof(uint16_t));
+    for (int line = 0; line < height; line += lines_per_chunk)
     {
-    	curr_transfer_size = MIN(total_size_bytes, DISPLAY_MAX_TRANSFER_SIZE);
-    	trans[chunk_ix].tx_buffer = line_ptr;        			//finally send the line data
-    	trans[chunk_ix].length=curr_transfer_size * 8;  	//Data length, in bits
-    	trans[chunk_ix].flags = 0; 							//undo SPI_TRANS_USE_TXDATA flag
-    	trans[chunk_ix].user =(void*)1;
-
-    	chunk_ix++;
-    	total_size_bytes -= curr_transfer_size;
-
-    	if(!isBufferConstant)
-    	{
-    		line_ptr += (curr_transfer_size / 2); //Not ideal... We have a U16 ptr, but transfer size is in bytes...
-    	}
+        int lines = MIN(lines_per_chunk, height - line);
+        uint16_t *strip = display_acquireStrip(width, lines);
+
+        render(strip, xPos, yPos + line, width, lines, ctx);
+        display_presentStrip(strip, xPos, yPos + line, width, lines);
     }
+}
 
-    trans[chunk_ix - 1].flags = 0;
-    priv_number_of_transfers = chunk_ix;
 
-    //Queue all transactions.
-    for (int ix=0; ix < chunk_ix; ix++)
+static void copy_from_frame_buffer(uint16_t *dest, int x, int y, int width, int height, void *ctx)
+{
+    const uint16_t *src = (const uint16_t *)ctx + (y * DISPLAY_WIDTH) + x;
+
+    for (int line = 0; line < height; line++)
     {
-        ret=spi_device_queue_trans(spi, &trans[ix], portMAX_DELAY);
-        assert(ret==ESP_OK);
+        memcpy(dest, src, width * sizeof(uint16_t));
+        dest += width;
+        src += DISPLAY_WIDTH;
     }
 }
 
 
-static void wait_display_data_finish(spi_device_handle_t spi)
+/* Collects results until the transaction with the given sequence number has completed. */
+static void wait_fence(spi_device_handle_t spi, uint32_t fence)
 {
     spi_transaction_t *rtrans;
     esp_err_t ret;
-    //Wait for all transactions to be done and get back the results.
-    for (int x=0; x < priv_number_of_transfers; x++)
+
+    while ((int32_t)(fence - priv_completed_count) > 0)
     {
         ret=spi_device_get_trans_result(spi, &rtrans, portMAX_DELAY);
         assert(ret==ESP_OK);
+        (void)ret;
         //We could inspect rtrans now if we received any info back. The LCD is treated as write-only, though.
+        priv_completed_count++;
     }
-    priv_number_of_transfers = 0u;
+}
+
+
+static void wait_display_data_finish(spi_device_handle_t spi)
+{
+    //Wait for all transactions to be done and get back the results.
+    wait_fence(spi, priv_queued_count);
+
+    //Then the whole ring is free again
+    priv_oldest_region = (priv_oldest_region + priv_regions_in_flight) % REGION_RING_SIZE;
+    priv_regions_in_flight = 0;
+    priv_pixel_tail = priv_pixel_head;
 }
@@ -45,8 +45,25 @@
 
 #define DISPLAY_MAX_TRANSFER_SIZE 40*320*2
 
+/* Granularity of the damage tracking used by display_present() and display_presentRegions().
+ * Matches the game grid. */
+#define DISPLAY_DIRTY_CELL_WIDTH  20u
+#define DISPLAY_DIRTY_CELL_HEIGHT 20u
+
+/* Renders the given area of the screen into dest, which is width pixels wide. */
+typedef void (*display_region_renderer_t)(uint16_t *dest, int x, int y, int width, int height, void *ctx);
+
+/* Apart from display_init(), whoever sends to the panel holds the SPI bus as SPI_BUS_CLIENT_DISPLAY
+ * until display_waitIdle() has returned, see spiBus.h. */
 void display_init(void);
 void display_drawScreenBuffer(uint16_t *buf);
+void display_markDirty(int x, int y, int width, int height);
+void display_markAllDirty(void);
+void display_present(uint16_t *buf);
+void display_presentRegions(display_region_renderer_t render, void *ctx);
+uint16_t *display_acquireStrip(int width, int height);
+void display_presentStrip(uint16_t *strip, int x, int y, int width, int height);
+void display_waitIdle(void);
 void display_fillRectangle(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color);
 void display_drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t *bmp_buf);
 
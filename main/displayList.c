@@ -0,0 +1,236 @@
+/*
+ * displayList.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "esp_system.h"
+
+#include "blit.h"
+#include "display.h"
+#include "displayList.h"
+
+/*
+ * The display list replaces the frame buffer when the game is built with
+ * CONFIG_ENGINAATOR_STRIP_RENDERER. Drawing records an item instead of writing pixels, and
+ * display_presentRegions() asks for the dirty parts of the screen one transfer strip at a time,
+ * which are rasterized from the list in drawing order.
+ *
+ * The list holds the whole scene, not just the last frame. To keep it bounded an opaque item
+ * removes every earlier item it covers completely, so redrawing a cell replaces what was there
+ * and a full screen fill empties the list. Colour keyed bitmaps, and those drawn from a run table,
+ * let what is under them show through, so they never remove anything.
+ */
+
+/*
+**====================================================================================
+** Private type definitions
+**====================================================================================
+*/
+
+typedef enum
+{
+    ITEM_FILL,
+    ITEM_BITMAP,
+    ITEM_KEYED_BITMAP,
+    ITEM_INDEXED_BITMAP,
+    ITEM_KEYED_INDEXED_BITMAP,
+    ITEM_RUN_BITMAP,
+} item_type_t;
+
+typedef struct
+{
+    item_type_t type;
+    int16_t x;              /* Where the whole item is placed */
+    int16_t y;
+    uint16_t width;
+    uint16_t height;
+    int16_t x0;             /* Visible part: clipped to the clip rectangle and the screen, end exclusive */
+    int16_t y0;
+    int16_t x1;
+    int16_t y1;
+    uint16_t color;         /* Fill colour, or the transparent colour of a keyed bitmap */
+    uint8_t bits_per_pixel; /* Of an indexed or run bitmap */
+    const void * pixels;    /* RGB565 pixels, or the indices of an indexed bitmap */
+    const uint16_t * palette;
+    const uint8_t * runs;
+} display_item_t;
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static void add_item(display_item_t * item, int clipX, int clipY, int clipWidth, int clipHeight);
+static void render_region(uint16_t * dest, int x, int y, int width, int height, void * ctx);
+
+/*
+**====================================================================================
+** Private variable declarations
+**====================================================================================
+*/
+
+static display_item_t priv_items[DISPLAY_LIST_MAX_ITEMS];
+static uint32_t priv_item_count = 0u;
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+void displayList_clear(void)
+{
+    priv_item_count = 0u;
+}
+
+
+void displayList_addFill(int x, int y, int width, int height, uint16_t color)
+{
+    display_item_t item = { .type = ITEM_FILL, .x = x, .y = y, .width = width, .height = height, .color = color };
+    add_item(&item, x, y, width, height);
+}
+
+
+/* Pixels are read at rasterization time, so they must stay valid while the item is on the list. */
+void displayList_addBitmap(int x, int y, int width, int height, const uint16_t * pixels,
+                           int clipX, int clipY, int clipWidth, int clipHeight)
+{
+    display_item_t item = { .type = ITEM_BITMAP, .x = x, .y = y, .width = width, .height = height, .pixels = pixels };
+    add_item(&item, clipX, clipY, clipWidth, clipHeight);
+}
+
+
+/* As displayList_addBitmap(), but pixels equal to key are not drawn. */
+void displayList_addKeyedBitmap(int x, int y, int width, int height, const uint16_t * pixels, uint16_t key,
+                                int clipX, int clipY, int clipWidth, int clipHeight)
+{
+    display_item_t item = { .type = ITEM_KEYED_BITMAP, .x = x, .y = y, .width = width, .height = height,
+                            .color = key, .pixels = pixels };
+    add_item(&item, clipX, clipY, clipWidth, clipHeight);
+}
+
+
+/* As displayList_addBitmap(), with the pixels in the indexed format of blit_copyIndexed(). The
+ * palette must stay valid too. */
+void displayList_addIndexedBitmap(int x, int y, int width, int height, const uint8_t * indices,
+                                  uint8_t bits_per_pixel, const uint16_t * palette, bool keyed,
+                                  int clipX, int clipY, int clipWidth, int clipHeight)
+{
+    display_item_t item = { .type = keyed ? ITEM_KEYED_INDEXED_BITMAP : ITEM_INDEXED_BITMAP, .x = x, .y = y,
+                            .width = width, .height = height, .bits_per_pixel = bits_per_pixel,
+                            .pixels = indices, .palette = palette };
+    add_item(&item, clipX, clipY, clipWidth, clipHeight);
+}
+
+
+/* As displayList_addKeyedBitmap(), for a bitmap in any format of blit_copyRuns() and its run table,
+ * which must stay valid too. */
+void displayList_addRunBitmap(int x, int y, int width, int height, const void * pixels, uint8_t bits_per_pixel,
+                              const uint16_t * palette, const uint8_t * runs,
+                              int clipX, int clipY, int clipWidth, int clipHeight)
+{
+    display_item_t item = { .type = ITEM_RUN_BITMAP, .x = x, .y = y, .width = width, .height = height,
+                            .bits_per_pixel = bits_per_pixel, .pixels = pixels, .palette = palette, .runs = runs };
+    add_item(&item, clipX, clipY, clipWidth, clipHeight);
+}
+
+
+/* Sends the dirty parts of the screen, rendering them straight into strips of the display's pixel ring. */
+void displayList_present(void)
+{
+    display_presentRegions(render_region, NULL);
+}
+
+
+uint32_t displayList_getItemCount(void)
+{
+    return priv_item_count;
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+static void add_item(display_item_t * item, int clipX, int clipY, int clipWidth, int clipHeight)
+{
+    uint32_t kept = 0u;
+
+    item->x0 = MAX(MAX(item->x, clipX), 0);
+    item->y0 = MAX(MAX(item->y, clipY), 0);
+    item->x1 = MIN(MIN(item->x + item->width, clipX + clipWidth), (int)DISPLAY_WIDTH);
+    item->y1 = MIN(MIN(item->y + item->height, clipY + clipHeight), (int)DISPLAY_HEIGHT);
+
+    if ((item->x0 >= item->x1) || (item->y0 >= item->y1))
+    {
+        return;
+    }
+
+    /* Drop everything this item hides. */
+    if ((item->type != ITEM_KEYED_BITMAP) && (item->type != ITEM_KEYED_INDEXED_BITMAP) && (item->type != ITEM_RUN_BITMAP))
+    {
+        for (uint32_t ix = 0u; ix < priv_item_count; ix++)
+        {
+            const display_item_t * old = &priv_items[ix];
+            bool covered = (old->x0 >= item->x0) && (old->x1 <= item->x1) && (old->y0 >= item->y0) && (old->y1 <= item->y1);
+
+            if (!covered)
+            {
+                priv_items[kept++] = *old;
+            }
+        }
+        priv_item_count = kept;
+    }
+
+    assert(priv_item_count < DISPLAY_LIST_MAX_ITEMS);
+    priv_items[priv_item_count++] = *item;
+}
+
+
+/* Rasterizes every item that overlaps the area into dest, which is width pixels wide. */
+static void render_region(uint16_t * dest, int x, int y, int width, int height, void * ctx)
+{
+    blit_surface_t surface = { .pixels = dest, .x = x, .y = y, .width = width, .height = height, .stride = width };
+
+    (void)ctx;
+
+    for (uint32_t ix = 0u; ix < priv_item_count; ix++)
+    {
+        const display_item_t * item = &priv_items[ix];
+        blit_rect_t visible = { item->x0, item->y0, item->x1 - item->x0, item->y1 - item->y0 };
+
+        switch (item->type)
+        {
+        case ITEM_FILL:
+            blit_fill(&surface, visible.x, visible.y, visible.width, visible.height, item->color);
+            break;
+        case ITEM_BITMAP:
+            blit_copy(&surface, item->x, item->y, item->width, item->height, item->pixels, &visible);
+            break;
+        case ITEM_KEYED_BITMAP:
+            blit_copyKeyed(&surface, item->x, item->y, item->width, item->height, item->pixels, item->color, &visible);
+            break;
+        case ITEM_INDEXED_BITMAP:
+        case ITEM_KEYED_INDEXED_BITMAP:
+            blit_copyIndexed(&surface, item->x, item->y, item->width, item->height, item->pixels,
+                             item->bits_per_pixel, item->palette, (item->type == ITEM_KEYED_INDEXED_BITMAP), &visible);
+            break;
+        case ITEM_RUN_BITMAP:
+            blit_copyRuns(&surface, item->x, item->y, item->width, item->height, item->pixels,
+                          item->bits_per_pixel, item->palette, item->runs, &visible);
+            break;
+        }
+    }
+}
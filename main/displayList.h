@@ -0,0 +1,31 @@
+/*
+ * displayList.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_DISPLAYLIST_H_
+#define MAIN_DISPLAYLIST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Room for a fill and a sprite in every grid cell, the background and the logo. */
+#define DISPLAY_LIST_MAX_ITEMS 512
+
+extern void displayList_clear(void);
+extern void displayList_addFill(int x, int y, int width, int height, uint16_t color);
+extern void displayList_addBitmap(int x, int y, int width, int height, const uint16_t * pixels,
+                                  int clipX, int clipY, int clipWidth, int clipHeight);
+extern void displayList_addKeyedBitmap(int x, int y, int width, int height, const uint16_t * pixels, uint16_t key,
+                                       int clipX, int clipY, int clipWidth, int clipHeight);
+extern void displayList_addIndexedBitmap(int x, int y, int width, int height, const uint8_t * indices,
+                                         uint8_t bits_per_pixel, const uint16_t * palette, bool keyed,
+                                         int clipX, int clipY, int clipWidth, int clipHeight);
+extern void displayList_addRunBitmap(int x, int y, int width, int height, const void * pixels, uint8_t bits_per_pixel,
+                                     const uint16_t * palette, const uint8_t * runs,
+                                     int clipX, int clipY, int clipWidth, int clipHeight);
+extern void displayList_present(void);
+extern uint32_t displayList_getItemCount(void);
+
+#endif /* MAIN_DISPLAYLIST_H_ */
@@ -0,0 +1,86 @@
+/*
+ * freeCells.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <assert.h>
+
+#include "freeCells.h"
+
+_Static_assert(GRID_CELLS < FREE_CELLS_TAKEN, "Cell positions must fit below FREE_CELLS_TAKEN");
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+/* Every cell free. */
+void freeCells_reset(freeCells_t * set)
+{
+    for (uint16_t cell = 0u; cell < GRID_CELLS; cell++)
+    {
+        set->cells[cell] = (grid_cell_t)cell;
+        set->position[cell] = (uint8_t)cell;
+    }
+
+    set->count = GRID_CELLS;
+}
+
+
+/* The last free cell moves into the hole, so the free ones stay at the front. */
+void freeCells_take(freeCells_t * set, grid_cell_t cell)
+{
+    uint8_t position = set->position[cell];
+    grid_cell_t last;
+
+    if (position == FREE_CELLS_TAKEN)
+    {
+        return;
+    }
+
+    set->count--;
+    last = set->cells[set->count];
+    set->cells[position] = last;
+    set->position[last] = position;
+    set->position[cell] = FREE_CELLS_TAKEN;
+}
+
+
+void freeCells_release(freeCells_t * set, grid_cell_t cell)
+{
+    if (set->position[cell] != FREE_CELLS_TAKEN)
+    {
+        return;
+    }
+
+    set->cells[set->count] = cell;
+    set->position[cell] = (uint8_t)set->count;
+    set->count++;
+}
+
+
+bool freeCells_isFree(const freeCells_t * set, grid_cell_t cell)
+{
+    return set->position[cell] != FREE_CELLS_TAKEN;
+}
+
+
+uint16_t freeCells_getCount(const freeCells_t * set)
+{
+    return set->count;
+}
+
+
+/* index must be below freeCells_getCount(). A uniformly random index gives a uniformly random cell. */
+grid_cell_t freeCells_get(const freeCells_t * set, uint16_t index)
+{
+    assert(index < set->count);
+    return set->cells[index];
+}
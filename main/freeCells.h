@@ -0,0 +1,33 @@
+/*
+ * freeCells.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_FREECELLS_H_
+#define MAIN_FREECELLS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "grid.h"
+
+/* The grid cells nothing stands on, as a dense array for picking one at random and a map from
+ * cell to array position for taking and releasing a cell, all in constant time. */
+typedef struct
+{
+    grid_cell_t cells[GRID_CELLS];      /* The first count entries are free, in no particular order */
+    uint8_t position[GRID_CELLS];       /* Index into cells, FREE_CELLS_TAKEN if not free */
+    uint16_t count;
+} freeCells_t;
+
+#define FREE_CELLS_TAKEN    0xFFu
+
+extern void freeCells_reset(freeCells_t * set);
+extern void freeCells_take(freeCells_t * set, grid_cell_t cell);
+extern void freeCells_release(freeCells_t * set, grid_cell_t cell);
+extern bool freeCells_isFree(const freeCells_t * set, grid_cell_t cell);
+extern uint16_t freeCells_getCount(const freeCells_t * set);
+extern grid_cell_t freeCells_get(const freeCells_t * set, uint16_t index);
+
+#endif /* MAIN_FREECELLS_H_ */
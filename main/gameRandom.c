@@ -0,0 +1,53 @@
+/*
+ * gameRandom.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include "gameRandom.h"
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+/* Xorshift never leaves zero, a zero seed is replaced with this. */
+#define GAME_RANDOM_ZERO_SEED   0x9E3779B9u
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+void gameRandom_seed(gameRandom_t * random, uint32_t seed)
+{
+    random->state = (seed != 0u) ? seed : GAME_RANDOM_ZERO_SEED;
+}
+
+
+uint32_t gameRandom_next(gameRandom_t * random)
+{
+    uint32_t x = random->state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    random->state = x;
+
+    return x;
+}
+
+
+/* A number from 0 to limit - 1. Scales instead of taking the remainder, so the low bits, the
+ * weakest ones of xorshift, do not decide it. */
+uint32_t gameRandom_below(gameRandom_t * random, uint32_t limit)
+{
+    return (uint32_t)(((uint64_t)gameRandom_next(random) * limit) >> 32);
+}
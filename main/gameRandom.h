@@ -0,0 +1,23 @@
+/*
+ * gameRandom.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_GAMERANDOM_H_
+#define MAIN_GAMERANDOM_H_
+
+#include <stdint.h>
+
+/* Random numbers for the game, xorshift32. The whole state is this one word, so a game started
+ * from the same seed makes the same choices, see replay.c */
+typedef struct
+{
+    uint32_t state;
+} gameRandom_t;
+
+extern void gameRandom_seed(gameRandom_t * random, uint32_t seed);
+extern uint32_t gameRandom_next(gameRandom_t * random);
+extern uint32_t gameRandom_below(gameRandom_t * random, uint32_t limit);
+
+#endif /* MAIN_GAMERANDOM_H_ */
@@ -0,0 +1,46 @@
+/*
+ * gameSnapshot.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_GAMESNAPSHOT_H_
+#define MAIN_GAMESNAPSHOT_H_
+
+#include <stdint.h>
+
+#include "assets.h"
+#include "grid.h"
+
+/* Everything the render task needs to draw one frame. The logic task fills one in after every
+ * update and hands it over through a mailbox, after that it is never changed again, so the two
+ * tasks share no other state. */
+
+typedef enum
+{
+    SNAPSHOT_SCREEN_MAIN_MENU,
+    SNAPSHOT_SCREEN_GAME,
+    SNAPSHOT_SCREEN_SETTINGS,
+} snapshot_screen_t;
+
+#define SNAPSHOT_MENU_BUTTONS   4u
+
+/* Content of a grid cell with nothing on it. */
+#define SNAPSHOT_CELL_EMPTY     0xFFu
+
+typedef struct
+{
+    uint32_t sequence;                                  /* Counts up with every snapshot */
+    uint32_t scene;                                     /* Changes when the screen has to be drawn from scratch */
+    snapshot_screen_t screen;
+
+    /* SNAPSHOT_SCREEN_MAIN_MENU and SNAPSHOT_SCREEN_SETTINGS, see ui.c */
+    uint8_t menu_selection;                             /* Highlighted menu button, 1 to SNAPSHOT_MENU_BUTTONS */
+    uint8_t speed;                                      /* Game speed, 1 to 3 */
+
+    /* SNAPSHOT_SCREEN_GAME */
+    uint8_t level;
+    uint8_t cells[GRID_CELLS];                          /* asset_handle_t of the sprite on each cell, or SNAPSHOT_CELL_EMPTY */
+} game_snapshot_t;
+
+#endif /* MAIN_GAMESNAPSHOT_H_ */
@@ -0,0 +1,24 @@
+/*
+ * grid.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_GRID_H_
+#define MAIN_GRID_H_
+
+#include <stdint.h>
+
+/* The playing field: 20 x 20 pixel cells covering the 320 x 240 display. */
+#define GRID_COLUMNS    16u
+#define GRID_ROWS       12u
+#define GRID_CELLS      (GRID_COLUMNS * GRID_ROWS)
+
+/* Cells are numbered row by row from the top left. */
+typedef uint8_t grid_cell_t;
+
+#define GRID_CELL(column, row)  ((grid_cell_t)(((row) * GRID_COLUMNS) + (column)))
+#define GRID_CELL_COLUMN(cell)  ((cell) % GRID_COLUMNS)
+#define GRID_CELL_ROW(cell)     ((cell) / GRID_COLUMNS)
+
+#endif /* MAIN_GRID_H_ */
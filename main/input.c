@@ -0,0 +1,375 @@
+/*
+ * input.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/gpio.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+
+#include "profiler.h"
+#include "input.h"
+
+/*
+ * The joystick axes are converted continuously by the ADC, which DMAs a frame of results at a
+ * time, so reading them costs the game nothing. The input task turns each frame into direction
+ * events and the button interrupt turns contact closures into press events. Both go into one
+ * queue with the time they happened, and the logic task takes them from there.
+ */
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+#define INPUT_X_CHANNEL             ADC_CHANNEL_2   /* GPIO 3 */
+#define INPUT_Y_CHANNEL             ADC_CHANNEL_7   /* GPIO 8 */
+#define INPUT_BUTTON_GPIO           GPIO_NUM_18     /* Active low */
+
+/* The two axes take turns, so each one is sampled at half this rate. */
+#define INPUT_SAMPLE_FREQ_HZ        2000u
+#define INPUT_SAMPLE_PERIOD_US      (1000000 / INPUT_SAMPLE_FREQ_HZ)
+/* Conversions per DMA frame. The input task wakes once per frame, every 8 ms. */
+#define INPUT_FRAME_SAMPLES         16u
+#define INPUT_FRAME_BYTES           (INPUT_FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES)
+#define INPUT_STORE_FRAMES          4u
+
+/* Raw 12 bit readings, the stick rests around 2048. A direction starts when the reading passes the
+ * outer threshold and ends only when it comes back past the inner one, so noise around a threshold
+ * cannot repeat it. */
+#define INPUT_AXIS_HIGH_ON          3600
+#define INPUT_AXIS_HIGH_OFF         3000
+#define INPUT_AXIS_LOW_ON           500
+#define INPUT_AXIS_LOW_OFF          1100
+/* Readings in a row that a change needs, 3 ms at the rate of one axis. */
+#define INPUT_AXIS_CONFIRM_SAMPLES  3u
+
+/* Edges this soon after an accepted one are contact bounce. */
+#define INPUT_BUTTON_DEBOUNCE_US    20000
+
+#define INPUT_QUEUE_LENGTH          16u
+
+/* Next to the logic task, which it preempts whenever a frame is ready. */
+#define INPUT_TASK_CORE             (portNUM_PROCESSORS - 1)
+#define INPUT_TASK_PRIORITY         (tskIDLE_PRIORITY + 6u)
+#define INPUT_TASK_STACK_SIZE       3072u
+
+/*
+**====================================================================================
+** Private type definitions
+**====================================================================================
+*/
+
+typedef struct
+{
+    adc_channel_t channel;
+    input_event_type_t low_event;   /* Reported when the stick goes to the low end */
+    input_event_type_t high_event;
+    int8_t state;                   /* -1 low end, 0 centre, 1 high end */
+    int8_t pending;                 /* Where the readings point while the change is confirmed */
+    uint8_t confirmations;
+    int64_t pending_since_us;
+} input_axis_t;
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static void input_task(void * param);
+static void axis_update(input_axis_t * axis, int raw, int64_t t_us);
+static bool button_update(int level, int64_t now_us);
+static void button_isr(void * arg);
+static void send_event(input_event_type_t type, int64_t timestamp_us);
+
+/*
+**====================================================================================
+** Private variable declarations
+**====================================================================================
+*/
+
+static adc_continuous_handle_t priv_adc;
+static QueueHandle_t priv_queue;
+static uint8_t priv_frame[INPUT_FRAME_BYTES];
+
+/* The stick is mounted mirrored: the high end of x is left. */
+static input_axis_t priv_axes[] =
+{
+    { .channel = INPUT_X_CHANNEL, .low_event = INPUT_EVENT_RIGHT, .high_event = INPUT_EVENT_LEFT },
+    { .channel = INPUT_Y_CHANNEL, .low_event = INPUT_EVENT_UP, .high_event = INPUT_EVENT_DOWN },
+};
+
+/* Debounced button state, shared by the interrupt and the input task */
+static portMUX_TYPE priv_button_lock = portMUX_INITIALIZER_UNLOCKED;
+static int priv_button_level;
+static int64_t priv_button_changed_us;
+
+/* Written from the interrupt as well, the rest of the statistics only by the logic task */
+static atomic_uint priv_dropped;
+static input_stats_t priv_stats;
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+void input_init(void)
+{
+    adc_continuous_handle_cfg_t handle_cfg =
+    {
+        .max_store_buf_size = INPUT_STORE_FRAMES * INPUT_FRAME_BYTES,
+        .conv_frame_size = INPUT_FRAME_BYTES,
+    };
+    adc_digi_pattern_config_t pattern[2];
+    adc_continuous_config_t adc_cfg =
+    {
+        .pattern_num = 2u,
+        .adc_pattern = pattern,
+        .sample_freq_hz = INPUT_SAMPLE_FREQ_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    gpio_config_t io_conf =
+    {
+        .pin_bit_mask = (1ULL << INPUT_BUTTON_GPIO),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_ANYEDGE,
+    };
+    esp_err_t ret;
+
+    for (int ix = 0; ix < 2; ix++)
+    {
+        pattern[ix].atten = ADC_ATTEN_DB_11;
+        pattern[ix].channel = priv_axes[ix].channel;
+        pattern[ix].unit = ADC_UNIT_1;
+        pattern[ix].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    priv_queue = xQueueCreate(INPUT_QUEUE_LENGTH, sizeof(input_event_t));
+    assert(priv_queue);
+
+    ESP_ERROR_CHECK(adc_continuous_new_handle(&handle_cfg, &priv_adc));
+    ESP_ERROR_CHECK(adc_continuous_config(priv_adc, &adc_cfg));
+
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+    priv_button_level = gpio_get_level(INPUT_BUTTON_GPIO);
+    priv_button_changed_us = esp_timer_get_time() - INPUT_BUTTON_DEBOUNCE_US;
+
+    /* Someone else may have installed the service already */
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_ERR_INVALID_STATE)
+    {
+        ESP_ERROR_CHECK(ret);
+    }
+    ESP_ERROR_CHECK(gpio_isr_handler_add(INPUT_BUTTON_GPIO, button_isr, NULL));
+
+    ESP_ERROR_CHECK(adc_continuous_start(priv_adc));
+    xTaskCreatePinnedToCore(input_task, "input", INPUT_TASK_STACK_SIZE, NULL, INPUT_TASK_PRIORITY, NULL, INPUT_TASK_CORE);
+}
+
+
+/* Takes the oldest event. Never blocks, returns false if there is none. */
+bool input_getEvent(input_event_t * event)
+{
+    return (xQueueReceive(priv_queue, event, 0) == pdTRUE);
+}
+
+
+/* Call once the game has acted on the event, this is where its latency is measured. */
+void input_markHandled(const input_event_t * event)
+{
+    int64_t latency_us = esp_timer_get_time() - event->timestamp_us;
+
+    priv_stats.events++;
+    priv_stats.latency_total_us += latency_us;
+    if (latency_us > priv_stats.latency_max_us)
+    {
+        priv_stats.latency_max_us = latency_us;
+    }
+}
+
+
+void input_getStats(input_stats_t * stats)
+{
+    *stats = priv_stats;
+    stats->dropped = atomic_load(&priv_dropped);
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+/* Turns each frame of conversions into direction events as it arrives. */
+static void input_task(void * param)
+{
+    (void)param;
+
+    while (1)
+    {
+        uint32_t length = 0u;
+        uint32_t samples;
+        int64_t now_us;
+        bool pressed;
+        int64_t start;
+
+        if (adc_continuous_read(priv_adc, priv_frame, sizeof(priv_frame), &length, ADC_MAX_DELAY) != ESP_OK)
+        {
+            continue;
+        }
+
+        start = profiler_start();
+
+        /* The frame ends now, each conversion before that is one sample period older. */
+        now_us = esp_timer_get_time();
+        samples = length / SOC_ADC_DIGI_RESULT_BYTES;
+
+        for (uint32_t ix = 0u; ix < samples; ix++)
+        {
+            const adc_digi_output_data_t * result = (const adc_digi_output_data_t *)&priv_frame[ix * SOC_ADC_DIGI_RESULT_BYTES];
+            int64_t t_us = now_us - (int64_t)(samples - 1u - ix) * INPUT_SAMPLE_PERIOD_US;
+
+            for (int axis = 0; axis < 2; axis++)
+            {
+                if (result->type2.channel == priv_axes[axis].channel)
+                {
+                    axis_update(&priv_axes[axis], result->type2.data, t_us);
+                }
+            }
+        }
+
+        /* The interrupt ignores the edges while the contacts bounce. If they came to rest on the
+         * other level, this catches it. */
+        portENTER_CRITICAL(&priv_button_lock);
+        pressed = button_update(gpio_get_level(INPUT_BUTTON_GPIO), now_us);
+        portEXIT_CRITICAL(&priv_button_lock);
+
+        if (pressed)
+        {
+            send_event(INPUT_EVENT_PRESS, now_us);
+        }
+
+        profiler_record(PROFILER_STAGE_INPUT, start);
+    }
+}
+
+
+/* Hysteresis plus a few readings in a row before the axis changes state. The event carries the
+ * time of the first of those readings. */
+static void axis_update(input_axis_t * axis, int raw, int64_t t_us)
+{
+    int8_t target = axis->state;
+
+    if (raw >= INPUT_AXIS_HIGH_ON)
+    {
+        target = 1;
+    }
+    else if (raw <= INPUT_AXIS_LOW_ON)
+    {
+        target = -1;
+    }
+    else if (((axis->state > 0) && (raw < INPUT_AXIS_HIGH_OFF)) || ((axis->state < 0) && (raw > INPUT_AXIS_LOW_OFF)))
+    {
+        target = 0;
+    }
+
+    if (target == axis->state)
+    {
+        axis->pending = target;
+        axis->confirmations = 0u;
+        return;
+    }
+
+    if ((target != axis->pending) || (axis->confirmations == 0u))
+    {
+        axis->pending = target;
+        axis->confirmations = 0u;
+        axis->pending_since_us = t_us;
+    }
+
+    if (++axis->confirmations < INPUT_AXIS_CONFIRM_SAMPLES)
+    {
+        return;
+    }
+
+    axis->state = target;
+    axis->confirmations = 0u;
+
+    if (target > 0)
+    {
+        send_event(axis->high_event, axis->pending_since_us);
+    }
+    else if (target < 0)
+    {
+        send_event(axis->low_event, axis->pending_since_us);
+    }
+}
+
+
+/* Moves the debounced button to level unless the last change was too recent. Returns true for a
+ * new press. Called with priv_button_lock held. */
+static bool IRAM_ATTR button_update(int level, int64_t now_us)
+{
+    if ((level == priv_button_level) || ((now_us - priv_button_changed_us) < INPUT_BUTTON_DEBOUNCE_US))
+    {
+        return false;
+    }
+
+    priv_button_level = level;
+    priv_button_changed_us = now_us;
+
+    return (level == 0);
+}
+
+
+static void IRAM_ATTR button_isr(void * arg)
+{
+    input_event_t event = { .type = INPUT_EVENT_PRESS, .timestamp_us = esp_timer_get_time() };
+    BaseType_t woken = pdFALSE;
+    bool pressed;
+
+    (void)arg;
+
+    portENTER_CRITICAL_ISR(&priv_button_lock);
+    pressed = button_update(gpio_get_level(INPUT_BUTTON_GPIO), event.timestamp_us);
+    portEXIT_CRITICAL_ISR(&priv_button_lock);
+
+    if (pressed && (xQueueSendFromISR(priv_queue, &event, &woken) != pdPASS))
+    {
+        atomic_fetch_add(&priv_dropped, 1u);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+
+/* From the input task. If the queue is full the game is not keeping up and the event is lost. */
+static void send_event(input_event_type_t type, int64_t timestamp_us)
+{
+    input_event_t event = { .type = type, .timestamp_us = timestamp_us };
+
+    if (xQueueSend(priv_queue, &event, 0) != pdPASS)
+    {
+        atomic_fetch_add(&priv_dropped, 1u);
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * input.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_INPUT_H_
+#define MAIN_INPUT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* What the player did. A stick direction is reported once when the stick is pushed that way,
+ * holding it there does not repeat it. */
+typedef enum
+{
+    INPUT_EVENT_LEFT,
+    INPUT_EVENT_RIGHT,
+    INPUT_EVENT_UP,
+    INPUT_EVENT_DOWN,
+    INPUT_EVENT_PRESS,
+} input_event_type_t;
+
+typedef struct
+{
+    input_event_type_t type;
+    int64_t timestamp_us;       /* esp_timer time the stick crossed the threshold or the button contact closed */
+} input_event_t;
+
+typedef struct
+{
+    uint32_t events;            /* Handled by the game, see input_markHandled() */
+    uint32_t dropped;           /* Lost because the game did not take them in time */
+    int64_t latency_total_us;   /* From the timestamp to input_markHandled() */
+    int64_t latency_max_us;
+} input_stats_t;
+
+extern void input_init(void);
+extern bool input_getEvent(input_event_t * event);
+extern void input_markHandled(const input_event_t * event);
+extern void input_getStats(input_stats_t * stats);
+
+#endif /* MAIN_INPUT_H_ */
@@ -0,0 +1,446 @@
+/*
+ * level.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include "display.h"
+#include "sdCard.h"
+#include "level.h"
+
+/*
+ * A level file is text, one statement per line. Empty lines and lines starting with '#' are
+ * skipped.
+ *
+ *   spawn random                   the snake starts on a random floor cell (the default)
+ *   spawn <column> <row>           or on this cell, counted from 0 at the top left
+ *   direction up|down|left|right   which way it starts moving (default right)
+ *   tile <c> floor|solid <RRGGBB> [<image> <x> <y>]
+ *                                  cells marked with the character c have this colour, and show
+ *                                  the part of the image placed at x, y on the screen that
+ *                                  overlaps them. The image is named like its file on the card,
+ *                                  such as enginaator. The snake dies on solid cells.
+ *   map                            followed by GRID_ROWS lines of GRID_COLUMNS tile characters
+ *
+ * The map is compiled into the collision grid of level_t, so a step tests one bit whatever the
+ * level looks like.
+ */
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+/* Longest level file and line */
+#define LEVEL_FILE_MAX_SIZE     1024u
+#define LEVEL_LINE_MAX_SIZE     64u
+
+/* Collision grid row of the board: the border columns set, the board columns clear. */
+#define COLLISION_OPEN_ROW      (~(((1u << GRID_COLUMNS) - 1u) << 1))
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static bool load_level(uint8_t number, char * buffer, uint32_t * length);
+static bool parse_level(const char * text, uint32_t length, level_t * level, const char * source);
+static bool parse_tile(const char * args, char * tile_char, bool * solid, level_tile_t * tile);
+static bool read_line(const char ** pos, const char * end, char * line);
+
+/*
+**====================================================================================
+** Private variable declarations
+**====================================================================================
+*/
+
+static const char *TAG = "Level";
+
+/* The levels the game comes with, used when the card has no file for them. */
+static const char * const priv_builtin_levels[LEVEL_COUNT] =
+{
+    /* An empty board */
+    "tile . floor FFFFFF\n"
+    "map\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n",
+
+    /* The logo in the middle is a wall */
+    "tile . floor FFFFFF\n"
+    "tile L solid FFFFFF enginaator 82 100\n"
+    "map\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "....LLLLLLLL....\n"
+    "....LLLLLLLL....\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n",
+
+    /* An empty board, like level 1. A card can give it walls. */
+    "tile . floor FFFFFF\n"
+    "map\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n"
+    "................\n",
+};
+
+static level_t priv_levels[LEVEL_COUNT];
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+/* Reads the levels from the SD card, from the app_main task after sdCard_init(). */
+void level_init(void)
+{
+    static char buffer[LEVEL_FILE_MAX_SIZE];
+    char source[32];
+    uint32_t length;
+    bool parsed;
+
+    for (uint8_t number = 1u; number <= LEVEL_COUNT; number++)
+    {
+        level_t * level = &priv_levels[number - 1u];
+
+        snprintf(source, sizeof(source), LEVEL_PATH_FORMAT, (unsigned)number);
+
+        if (load_level(number, buffer, &length) && parse_level(buffer, length, level, source))
+        {
+            ESP_LOGI(TAG, "Level %u from %s", (unsigned)number, source);
+            level->from_card = true;
+            continue;
+        }
+
+        /* The built in levels are part of the program, one that does not parse is a bug. */
+        snprintf(source, sizeof(source), "built in level %u", (unsigned)number);
+        parsed = parse_level(priv_builtin_levels[number - 1u], strlen(priv_builtin_levels[number - 1u]), level, source);
+        assert(parsed);
+        (void)parsed;
+    }
+}
+
+
+/* Level 1 to LEVEL_COUNT. */
+const level_t * level_get(uint8_t number)
+{
+    assert((number >= 1u) && (number <= LEVEL_COUNT));
+    return &priv_levels[number - 1u];
+}
+
+
+/* The cell the snake starts on. A random one is drawn again until it is not solid, the parser
+ * makes sure there is a floor cell to find. */
+grid_cell_t level_pickSpawn(const level_t * level, gameRandom_t * random)
+{
+    uint32_t column;
+    uint32_t row;
+
+    if (!level->random_spawn)
+    {
+        return level->spawn;
+    }
+
+    do
+    {
+        column = gameRandom_below(random, GRID_COLUMNS);
+        row = gameRandom_below(random, GRID_ROWS);
+    } while (level_isSolid(level, (int)column, (int)row));
+
+    return GRID_CELL(column, row);
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+/* Reads the level file into buffer. Returns false if the card has none or it is too long. */
+static bool load_level(uint8_t number, char * buffer, uint32_t * length)
+{
+    static sdCard_prefetch_t request;
+    char path[32];
+
+    snprintf(path, sizeof(path), LEVEL_PATH_FORMAT, (unsigned)number);
+    if (sdCard_Prefetch_file(&request, path, buffer, LEVEL_FILE_MAX_SIZE) != ESP_OK)
+    {
+        return false;
+    }
+
+    while (!sdCard_Prefetch_done(&request))
+    {
+        vTaskDelay(1);
+    }
+
+    if (request.result != ESP_OK)
+    {
+        return false;
+    }
+
+    if (request.length == LEVEL_FILE_MAX_SIZE)
+    {
+        ESP_LOGE(TAG, "%s is longer than %u bytes", path, LEVEL_FILE_MAX_SIZE);
+        return false;
+    }
+
+    *length = request.length;
+    return true;
+}
+
+
+/* Fills in level from the text of a level file. Returns false, and logs why, if it is not a valid
+ * level. source names the text in the log. */
+static bool parse_level(const char * text, uint32_t length, level_t * level, const char * source)
+{
+    const char * pos = text;
+    const char * end = text + length;
+    char line[LEVEL_LINE_MAX_SIZE];
+    char tile_chars[LEVEL_MAX_TILES];
+    bool tile_solid[LEVEL_MAX_TILES];
+    uint8_t tile_count = 0u;
+    bool have_map = false;
+    bool have_floor = false;
+    uint32_t line_number = 0u;
+    int column;
+    int row;
+
+    memset(level, 0, sizeof(*level));
+    level->random_spawn = true;
+    level->direction = LEVEL_DIRECTION_RIGHT;
+
+    while (!have_map && read_line(&pos, end, line))
+    {
+        line_number++;
+
+        if ((line[0] == '\0') || (line[0] == '#'))
+        {
+            continue;
+        }
+
+        if (strcmp(line, "spawn random") == 0)
+        {
+            level->random_spawn = true;
+        }
+        else if (sscanf(line, "spawn %d %d", &column, &row) == 2)
+        {
+            if ((column < 0) || (column >= (int)GRID_COLUMNS) || (row < 0) || (row >= (int)GRID_ROWS))
+            {
+                ESP_LOGE(TAG, "%s line %u: spawn is off the board", source, (unsigned)line_number);
+                return false;
+            }
+            level->random_spawn = false;
+            level->spawn = GRID_CELL(column, row);
+        }
+        else if (strncmp(line, "direction ", 10) == 0)
+        {
+            static const char * const names[] = { "up", "down", "left", "right" };
+            uint32_t ix;
+
+            for (ix = 0u; (ix < 4u) && (strcmp(&line[10], names[ix]) != 0); ix++)
+            {
+            }
+            if (ix == 4u)
+            {
+                ESP_LOGE(TAG, "%s line %u: unknown direction", source, (unsigned)line_number);
+                return false;
+            }
+            level->direction = (level_direction_t)ix;
+        }
+        else if (strncmp(line, "tile ", 5) == 0)
+        {
+            if (tile_count == LEVEL_MAX_TILES)
+            {
+                ESP_LOGE(TAG, "%s line %u: more than %u tiles", source, (unsigned)line_number, LEVEL_MAX_TILES);
+                return false;
+            }
+            if (!parse_tile(&line[5], &tile_chars[tile_count], &tile_solid[tile_count], &level->tile_defs[tile_count]))
+            {
+                ESP_LOGE(TAG, "%s line %u: bad tile", source, (unsigned)line_number);
+                return false;
+            }
+            tile_count++;
+        }
+        else if (strcmp(line, "map") == 0)
+        {
+            have_map = true;
+        }
+        else
+        {
+            ESP_LOGE(TAG, "%s line %u: unknown statement", source, (unsigned)line_number);
+            return false;
+        }
+    }
+
+    if (!have_map)
+    {
+        ESP_LOGE(TAG, "%s has no map", source);
+        return false;
+    }
+
+    level->collision[0] = ~0u;
+    level->collision[GRID_ROWS + 1u] = ~0u;
+
+    for (row = 0; row < (int)GRID_ROWS; row++)
+    {
+        line_number++;
+        if (!read_line(&pos, end, line) || (strlen(line) != GRID_COLUMNS))
+        {
+            ESP_LOGE(TAG, "%s line %u: map rows must be %u cells wide", source, (unsigned)line_number, GRID_COLUMNS);
+            return false;
+        }
+
+        level->collision[row + 1] = COLLISION_OPEN_ROW;
+
+        for (column = 0; column < (int)GRID_COLUMNS; column++)
+        {
+            uint8_t tile;
+
+            for (tile = 0u; (tile < tile_count) && (tile_chars[tile] != line[column]); tile++)
+            {
+            }
+            if (tile == tile_count)
+            {
+                ESP_LOGE(TAG, "%s line %u: no tile '%c'", source, (unsigned)line_number, line[column]);
+                return false;
+            }
+
+            level->tiles[GRID_CELL(column, row)] = tile;
+            if (tile_solid[tile])
+            {
+                level->collision[row + 1] |= 1u << (column + 1);
+            }
+            else
+            {
+                have_floor = true;
+            }
+        }
+    }
+
+    if (level->random_spawn ? !have_floor : level_isSolid(level, GRID_CELL_COLUMN(level->spawn), GRID_CELL_ROW(level->spawn)))
+    {
+        ESP_LOGE(TAG, "%s: the snake cannot start on a solid cell", source);
+        return false;
+    }
+
+    return true;
+}
+
+
+/* Parses the arguments of a tile statement. */
+static bool parse_tile(const char * args, char * tile_char, bool * solid, level_tile_t * tile)
+{
+    char kind[8];
+    char image[24];
+    unsigned int rgb;
+    int image_x;
+    int image_y;
+    int fields = sscanf(args, "%c %7s %6x %23s %d %d", tile_char, kind, &rgb, image, &image_x, &image_y);
+
+    if (((fields != 3) && (fields != 6)) || (*tile_char == ' '))
+    {
+        return false;
+    }
+
+    if (strcmp(kind, "solid") == 0)
+    {
+        *solid = true;
+    }
+    else if (strcmp(kind, "floor") == 0)
+    {
+        *solid = false;
+    }
+    else
+    {
+        return false;
+    }
+
+    tile->color = CONVERT_888RGB_TO_565RGB((rgb >> 16) & 0xFFu, (rgb >> 8) & 0xFFu, rgb & 0xFFu);
+    tile->has_image = (fields == 6);
+    if (tile->has_image)
+    {
+        if (!assets_find(image, &tile->image))
+        {
+            return false;
+        }
+        tile->image_x = (int16_t)image_x;
+        tile->image_y = (int16_t)image_y;
+    }
+
+    return true;
+}
+
+
+/* Copies the next line into line, without the line ending. Returns false at the end of the text
+ * or if the line does not fit. */
+static bool read_line(const char ** pos, const char * end, char * line)
+{
+    uint32_t length = 0u;
+
+    if (*pos >= end)
+    {
+        return false;
+    }
+
+    while ((*pos < end) && (**pos != '\n'))
+    {
+        if (length == (LEVEL_LINE_MAX_SIZE - 1u))
+        {
+            return false;
+        }
+        if (**pos != '\r')
+        {
+            line[length++] = **pos;
+        }
+        (*pos)++;
+    }
+
+    if (*pos < end)
+    {
+        (*pos)++;
+    }
+    line[length] = '\0';
+    return true;
+}
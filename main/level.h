@@ -0,0 +1,76 @@
+/*
+ * level.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_LEVEL_H_
+#define MAIN_LEVEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "assets.h"
+#include "grid.h"
+#include "gameRandom.h"
+
+/* Levels 1 to LEVEL_COUNT are read from LEVEL_PATH_FORMAT on the SD card by level_init(). A level
+ * that is missing from the card, or does not parse, is the built in one. The file format is
+ * described in level.c. */
+#define LEVEL_COUNT         3u
+#define LEVEL_PATH_FORMAT   "/levels/level%u.txt"
+
+/* Background tiles a level can define. */
+#define LEVEL_MAX_TILES     8u
+
+/* In the same order as the game's directions. */
+typedef enum
+{
+    LEVEL_DIRECTION_UP,
+    LEVEL_DIRECTION_DOWN,
+    LEVEL_DIRECTION_LEFT,
+    LEVEL_DIRECTION_RIGHT,
+} level_direction_t;
+
+/* What the background of a cell looks like: a colour, with the part of an image that overlaps the
+ * cell on top if the tile has one. The image is placed at (image_x, image_y) on the screen, so
+ * neighbouring cells with the same tile show neighbouring parts of it. */
+typedef struct
+{
+    uint16_t color;             /* RGB565 in the display's byte order */
+    bool has_image;
+    asset_handle_t image;
+    int16_t image_x;
+    int16_t image_y;
+} level_tile_t;
+
+typedef struct
+{
+    /* The collision grid: bit column + 1 of entry row + 1 is set if the snake dies on that cell.
+     * The grid has a border of set bits around the board, so running off the board is a wall
+     * like any other and needs no bounds check. */
+    uint32_t collision[GRID_ROWS + 2u];
+    uint8_t tiles[GRID_CELLS];                  /* Index into tile_defs of every cell */
+    level_tile_t tile_defs[LEVEL_MAX_TILES];
+    bool random_spawn;                          /* Otherwise the snake starts on spawn */
+    grid_cell_t spawn;
+    level_direction_t direction;                /* Which way the snake starts moving */
+    bool from_card;                             /* Otherwise it is the built in level */
+} level_t;
+
+extern void level_init(void);
+extern const level_t * level_get(uint8_t number);
+extern grid_cell_t level_pickSpawn(const level_t * level, gameRandom_t * random);
+
+/* Column and row may be one cell off the board. */
+static inline bool level_isSolid(const level_t * level, int column, int row)
+{
+    return ((level->collision[row + 1] >> (column + 1)) & 1u) != 0u;
+}
+
+static inline const level_tile_t * level_getTile(const level_t * level, grid_cell_t cell)
+{
+    return &level->tile_defs[level->tiles[cell]];
+}
+
+#endif /* MAIN_LEVEL_H_ */
@@ -0,0 +1,81 @@
+/*
+ * mailbox.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stddef.h>
+#include <assert.h>
+
+#include "mailbox.h"
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+#define MAILBOX_INDEX_MASK  0x03u
+#define MAILBOX_FRESH       0x04u
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+/* The three buffers must be the same size. Call before either task uses the mailbox. */
+void mailbox_init(mailbox_t * mailbox, void * buffer0, void * buffer1, void * buffer2)
+{
+    assert((buffer0 != NULL) && (buffer1 != NULL) && (buffer2 != NULL));
+
+    mailbox->buffers[0] = buffer0;
+    mailbox->buffers[1] = buffer1;
+    mailbox->buffers[2] = buffer2;
+    mailbox->write_index = 0u;
+    atomic_init(&mailbox->latest, 1u);
+    mailbox->read_index = 2u;
+}
+
+
+/* Producer side: the buffer to fill in. It is not seen by the consumer until mailbox_publish(). */
+void * mailbox_getWriteBuffer(mailbox_t * mailbox)
+{
+    return mailbox->buffers[mailbox->write_index];
+}
+
+
+/* Producer side: makes the write buffer the latest message and takes over the previous latest one
+ * for the next write. Release makes the contents visible before the index, acquire makes sure the
+ * consumer is done with the buffer we get back. */
+void mailbox_publish(mailbox_t * mailbox)
+{
+    uint_fast8_t previous = atomic_exchange_explicit(&mailbox->latest, mailbox->write_index | MAILBOX_FRESH,
+                                                     memory_order_acq_rel);
+
+    mailbox->write_index = previous & MAILBOX_INDEX_MASK;
+}
+
+
+/* Consumer side: returns the latest message if there is one that was not taken yet, else NULL.
+ * The message stays valid until the next call that returns non-NULL. */
+const void * mailbox_take(mailbox_t * mailbox)
+{
+    uint_fast8_t previous;
+
+    if ((atomic_load_explicit(&mailbox->latest, memory_order_relaxed) & MAILBOX_FRESH) == 0u)
+    {
+        return NULL;
+    }
+
+    /* Only the producer sets the fresh flag, so the exchange below still gets a fresh message. */
+    previous = atomic_exchange_explicit(&mailbox->latest, mailbox->read_index, memory_order_acq_rel);
+    mailbox->read_index = previous & MAILBOX_INDEX_MASK;
+
+    return mailbox->buffers[mailbox->read_index];
+}
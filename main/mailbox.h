@@ -0,0 +1,34 @@
+/*
+ * mailbox.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_MAILBOX_H_
+#define MAIN_MAILBOX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* Hands the latest of a stream of messages from one producer task to one consumer task without
+ * locks. There are three buffers: the producer owns one and fills it, the consumer owns one and
+ * reads it, and the third holds the latest finished message. Publishing and taking are a single
+ * atomic exchange with that third buffer, so neither side ever waits for the other. Messages the
+ * consumer had no time for are overwritten, it always gets the newest one. */
+#define MAILBOX_BUFFERS 3u
+
+typedef struct
+{
+    void * buffers[MAILBOX_BUFFERS];
+    atomic_uint_fast8_t latest;     /* Index of the shared buffer, plus MAILBOX_FRESH if it has not been taken */
+    uint8_t write_index;            /* Owned by the producer */
+    uint8_t read_index;             /* Owned by the consumer */
+} mailbox_t;
+
+extern void mailbox_init(mailbox_t * mailbox, void * buffer0, void * buffer1, void * buffer2);
+extern void * mailbox_getWriteBuffer(mailbox_t * mailbox);
+extern void mailbox_publish(mailbox_t * mailbox);
+extern const void * mailbox_take(mailbox_t * mailbox);
+
+#endif /* MAIN_MAILBOX_H_ */
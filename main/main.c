@@ -5,20 +5,43 @@
 */
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include <unistd.h>
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_task_wdt.h"
+#include "esp_timer.h"
+#include "esp_random.h"
 
 /* Display driver is defined in display.c and display.h
  * Note that when you add new files to the project, then CMakeLists.txt also needs to be updated for these files to be built. */
 #include "display.h"
+/* The SD card and the display take turns on the SPI bus, see spiBus.c */
+#include "spiBus.h"
 /* The SD card functionality has been moved to its own separate file for this project. */
 #include "sdCard.h"
-#include "driver/adc.h"
-#include "esp_adc_cal.h"
-static esp_adc_cal_characteristics_t adc1_chars;
+/* All images are loaded once at startup into a resident atlas, see assets.c */
+#include "assets.h"
+#include "spritePool.h"
+/* Drawing happens in its own task, from the snapshots this file publishes. See render.c */
+#include "render.h"
+#include "gameSnapshot.h"
+#include "mailbox.h"
+#include "snakeBody.h"
+#include "scheduler.h"
+/* The joystick is sampled in the background, the game only takes events from a queue. See input.c */
+#include "input.h"
+/* Stage timings, type 'p' on the serial console for a report. See profiler.c */
+#include "profiler.h"
+/* Input can be recorded to and replayed from the SD card, see replay.c */
+#include "replay.h"
+#include "gameRandom.h"
+/* Walls, spawn point and background of every level, see level.c */
+#include "level.h"
+
 /*
 **====================================================================================
 ** Private constant definitions
@@ -27,10 +50,7 @@ static esp_adc_cal_characteristics_t adc1_chars;
 
 #define Private static
 
-#define PIN_NUM_CLK   12	/* SPI Clock pin */
-#define PIN_NUM_MOSI  11	/* SPI Master Out, Slave in  - The ESP32 transmits data over this pin */
-#define PIN_NUM_MISO  13	/* SPI Master In, Slave Out  - The ESP32 receives data over this pin. */
-
+/* The SPI bus pins (clock 12, MOSI 11, MISO 13) are defined in spiBus.c */
 /* Note that additional connections are required for the display to work. These are defined in display.c */
 /* PIN_NUM_DC         5  - Data/Control pin  		*/
 /* PIN_NUM_RST        3  - Display Reset pin 		*/
@@ -45,7 +65,24 @@ static esp_adc_cal_characteristics_t adc1_chars;
 /* #define GHOST_TEST */
 
 
-#define MAX_SNAKE_LENGTH 100
+/* How often the heap and sprite pool usage is printed, to check that memory stays flat. */
+#define MEMORY_LOG_PERIOD_MS 30000u
+
+/* Time between snake steps at game speed 1. Speeds 2 and 3 divide it. */
+#define GAME_STEP_PERIOD_MS 400u
+
+/* The logic task handles the joystick events and publishes a snapshot this often. */
+#define LOGIC_PERIOD_MS 40u
+
+/* The render task stays on the core app_main runs on, where the SPI driver installed its interrupt,
+ * and the game logic gets the other core. On a single core build they share core 0. */
+#define RENDER_TASK_CORE       0
+#define RENDER_TASK_PRIORITY   (tskIDLE_PRIORITY + 4u)
+#define RENDER_TASK_STACK_SIZE 4096u
+#define LOGIC_TASK_CORE        (portNUM_PROCESSORS - 1)
+#define LOGIC_TASK_PRIORITY    (tskIDLE_PRIORITY + 5u)
+#define LOGIC_TASK_STACK_SIZE  4096u
+
 #define GRID_WIDTH 20
 #define GRID_HEIGHT 20
 
@@ -55,18 +92,12 @@ static esp_adc_cal_characteristics_t adc1_chars;
 **====================================================================================
 */
 
-#define SET_FRAME_BUF_PIXEL(buf,x,y,color) *((buf) + (x) + (320*(y)))=color
 
 /*
 **====================================================================================
 ** Private type definitions
 **====================================================================================
 */
-	enum ScreenState{
-		SCREEN_MAIN_MENU,
-		SCREEN_GAME,
-		SCREEN_SETTINGS
-	};
 	enum MenuOption{
 		OPTION_LEVELS,
 		OPTION_SETTINGS,
@@ -83,21 +114,18 @@ static esp_adc_cal_characteristics_t adc1_chars;
 		int y;
 	};
 	struct Snake{
-		struct SnakeSegment body[MAX_SNAKE_LENGTH];
-		int length;
+		snakeBody_t body;
+		struct SnakeSegment head;	/* Pixel position, may be off the board after a step */
 		enum Direction direction;
 		int status;
+		bool hitWall;
+		bool hitItself;
 	};
 	struct Food
 	{
 		int x;
 		int y;
-		const char* foodFilePath;
-	};
-	struct intTriple{
-		int a;
-		int b;
-		int c;
+		asset_handle_t asset;
 	};
 /*
 **====================================================================================
@@ -105,30 +133,28 @@ static esp_adc_cal_characteristics_t adc1_chars;
 **====================================================================================
 */
 
-Private uint8_t initialize_spi(void);
-Private void drawRectangleInFrameBuf(int xPos, int yPos, int width, int height, uint16_t color);
-Private void drawBmpInFrameBuf(int xPos, int yPos, int width, int height, uint16_t * data_buf);
-Private void drawSnake(void);
+Private void logicTask(void * param);
+Private void renderTask(void * param);
+Private void publishSnapshot(void);
 Private void snakeEat(void);
 Private void snakeDie(void);
+Private void snakeWin(void);
+Private void logGameStats(void);
 Private void snakeCollision(void);
-Private void drawBackground(void);
-Private void drawSnakeGame(void);
-Private void foodSpawn(void);
-Private void drawFood(void);
+Private void stepSnakeGame(void);
+Private bool foodSpawn(void);
 Private void gameLoop(void);
 Private void menuLoop(void);
 Private void initLevel(void);
-Private void drawMenu(void);
 Private void optionsLoop(void);
-Private void drawOptions(void);
-Private void changeMenuSelection(int selectedMenuBtn);
-Private void updateOptionSelection(int option);
 Private void updateSnakePosition(void);
+Private struct SnakeSegment cellPosition(grid_cell_t cell);
+Private grid_cell_t positionCell(struct SnakeSegment position);
+Private void moveSnake(input_event_type_t input);
 
-Private struct intTriple handleInputs(void);
-
-Private void drawEnginaator(void);
+Private void logMemoryUsage(void);
+Private void logInputStats(void);
+Private void logBusUsage(void);
 
 /*
 **====================================================================================
@@ -136,29 +162,34 @@ Private void drawEnginaator(void);
 **====================================================================================
 */
 
-uint16_t * priv_frame_buffer;
 Private struct Snake snake = {
-	.body = {{0, 0}},
-	.length = 2,
 	.direction = RIGHT,
 	.status = 0
 };
-uint16_t * priv_snake_buffer;
-uint16_t * priv_snake_body_buffer;
-uint16_t * priv_food_buffer;
-uint16_t * priv_enginaator_buffer;
-uint16_t * priv_levelselect1_buffer;
-uint16_t * priv_levelselect2_buffer;
-uint16_t * priv_levelselect3_buffer;
-uint16_t * priv_settings_buffer;
-uint16_t * priv_settingsbtn_buffer;
 int level = 1;
-int option = 1;
 int selectedMenuBtn = 1;
 int gameSpeed = 1;
 struct Food food;
+/* Decides where the snake starts and the food lands. Seeded once at boot, see replay_init() */
+Private gameRandom_t priv_random;
+
+/* The level being played, set by initLevel() */
+Private const level_t * priv_level;
 
-enum ScreenState currentScreen = SCREEN_MAIN_MENU;
+/* Paces the snake steps, see gameLoop() */
+Private scheduler_t priv_game_scheduler;
+
+snapshot_screen_t currentScreen = SNAPSHOT_SCREEN_MAIN_MENU;
+
+/* Game state handed from the logic task to the render task. Only the mailbox is shared. */
+Private game_snapshot_t priv_snapshots[MAILBOX_BUFFERS];
+Private mailbox_t priv_snapshot_mailbox;
+Private uint32_t priv_snapshot_sequence = 0u;
+/* Bumped whenever a level starts, so the render task draws it from scratch */
+Private uint32_t priv_scene = 0u;
+
+Private TaskHandle_t priv_logic_task;
+Private TaskHandle_t priv_render_task;
 
 /*
 **====================================================================================
@@ -167,19 +198,16 @@ enum ScreenState currentScreen = SCREEN_MAIN_MENU;
 */
 void app_main(void)
 {
-	uint8_t res;
+	bool res;
 
 	/* Check how much RAM we have currently available... */
-	printf("Total available memory: %u bytes\n", heap_caps_get_total_size(MALLOC_CAP_8BIT));
-    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 0, &adc1_chars);
-	/*Allocate memory for the frame buffer from the heap. */
-    priv_frame_buffer = heap_caps_malloc(240*320*sizeof(uint16_t), MALLOC_CAP_DMA);
-    assert(priv_frame_buffer);
+	printf("Total available memory: %zu bytes\n", heap_caps_get_total_size(MALLOC_CAP_8BIT));
+	render_init();
 
-	/*Call the function to initialize the SPI peripheral connected to the SD card. */
-	res = initialize_spi();
+	/* Initialize the SPI bus that the SD card and the display share. */
+	res = spiBus_init();
 
-	if(res == 1u)
+	if(res)
 	{
 		/* Initialize the Sd Card logic as well as the display driver.
 		 * Note that these devices are on the same SPI bus. The Chip Select pins allow us to
@@ -187,449 +215,391 @@ void app_main(void)
 		display_init();
 		sdCard_init();
 
+		spiBus_acquire(SPI_BUS_CLIENT_DISPLAY, SPI_BUS_NO_DEADLINE);
  		display_fillRectangle(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, COLOR_ORANGE);
-		vTaskDelay(1000u / portTICK_PERIOD_MS);
-
-		changeMenuSelection(1);
+		display_waitIdle();
+		spiBus_release(SPI_BUS_CLIENT_DISPLAY);
 
-		// load snake image
-		priv_snake_buffer = heap_caps_malloc(20 * 20 * sizeof(uint16_t), MALLOC_CAP_DMA);
-		assert(priv_snake_buffer);
-		sdCard_Read_bmp_file("/images/snake_head.bmp", priv_snake_buffer);
-
-		priv_snake_body_buffer = heap_caps_malloc(20 * 20 * sizeof(uint16_t), MALLOC_CAP_DMA);
-		assert(priv_snake_body_buffer);
-		sdCard_Read_bmp_file("/images/snake_body.bmp", priv_snake_body_buffer);
-
-		/* Load an image from the SD Card into the frame buffer */
-/* 		sdCard_Read_bmp_file("/logo.bmp", priv_frame_buffer);
-
-
-		display_drawBitmap(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, priv_frame_buffer); */
+		/* Load every image now, the game loop never reads the SD card. */
+		assets_init();
+		level_init();
+		vTaskDelay(1000u / portTICK_PERIOD_MS);
+	}
+	else
+	{
+		return;
 	}
-	
 
+	/* From here on the display belongs to the render task and the joystick to the logic task.
+	 * The render task has to exist before the logic task publishes its first snapshot. */
+	profiler_init(LOGIC_PERIOD_MS * 1000);
+	input_init();
+	gameRandom_seed(&priv_random, replay_init(esp_random()));
+	mailbox_init(&priv_snapshot_mailbox, &priv_snapshots[0], &priv_snapshots[1], &priv_snapshots[2]);
+
+	xTaskCreatePinnedToCore(renderTask, "render", RENDER_TASK_STACK_SIZE, NULL, RENDER_TASK_PRIORITY, &priv_render_task, RENDER_TASK_CORE);
+	assert(priv_render_task);
+	xTaskCreatePinnedToCore(logicTask, "logic", LOGIC_TASK_STACK_SIZE, NULL, LOGIC_TASK_PRIORITY, &priv_logic_task, LOGIC_TASK_CORE);
+	assert(priv_logic_task);
+}
 
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
 
-	/* The idea is that we will try to keep a cyclic process that is called every 40 milliseconds, we call our
-	 * drawing functions and then delay for the period remaining.
+/* Handles the joystick events, runs the game and publishes what the screen should show. Never draws. */
+Private void logicTask(void * param)
+{
+	(void)param;
+
+	/* The idea is that we will try to keep a cyclic process that is called every 40 milliseconds, we
+	 * update the game and then delay for the period remaining. The drawing happens in parallel in renderTask().
 	 */
 
 	TickType_t xLastWakeTime;
-	const TickType_t xFrequency = 40u / portTICK_PERIOD_MS;
+	const TickType_t xFrequency = LOGIC_PERIOD_MS / portTICK_PERIOD_MS;
 	xLastWakeTime = xTaskGetTickCount ();
+	TickType_t lastMemoryLogTicks = xLastWakeTime;
+
+	logMemoryUsage();
 
-	/* Main CPU cycle */
 	while(1)
 	{
+		int64_t tick_start = profiler_start();
 
 		switch (currentScreen) {
-        case SCREEN_MAIN_MENU:
+        case SNAPSHOT_SCREEN_MAIN_MENU:
             menuLoop();
             break;
-        case SCREEN_GAME:
+        case SNAPSHOT_SCREEN_GAME:
         	gameLoop();
             break;
-        case SCREEN_SETTINGS:
+        case SNAPSHOT_SCREEN_SETTINGS:
 			optionsLoop();
             break;
 		}
+		replay_endTick();
+
+		publishSnapshot();
+		profiler_record(PROFILER_STAGE_SIMULATION, tick_start);
+
+		profiler_pollConsole();
+
+		if ((xTaskGetTickCount() - lastMemoryLogTicks) >= (MEMORY_LOG_PERIOD_MS / portTICK_PERIOD_MS))
+		{
+			logMemoryUsage();
+			logInputStats();
+			logBusUsage();
+			lastMemoryLogTicks = xTaskGetTickCount();
+		}
 
 		vTaskDelayUntil( &xLastWakeTime, xFrequency );
 		
 	}
 }
 
-/*
-**====================================================================================
-** Private function definitions
-**====================================================================================
-*/
-
-/* This function initializest the SPI interface, but does not yet add any devies on it.  */
-Private uint8_t initialize_spi(void)
+/* Draws the newest snapshot whenever the logic task publishes one. If drawing a frame takes longer
+ * than a logic period, the snapshots published meanwhile are skipped. A frame should be on the
+ * panel before the next snapshot comes, which is the deadline it asks the SPI bus for. */
+Private void renderTask(void * param)
 {
-    esp_err_t ret;
-
-    printf("Setting up SPI peripheral\n");
-
-    spi_bus_config_t bus_cfg =
-    {
-        .mosi_io_num = PIN_NUM_MOSI,
-        .miso_io_num = PIN_NUM_MISO,
-        .sclk_io_num = PIN_NUM_CLK,
-        .quadwp_io_num = -1,
-        .quadhd_io_num = -1,
-        .max_transfer_sz = DISPLAY_MAX_TRANSFER_SIZE,
-    };
-
-    ret = spi_bus_initialize(SPI2_HOST, &bus_cfg, SPI_DMA_CH_AUTO);
-
-    if (ret != ESP_OK)
-    {
-        printf("Failed to initialize bus.\n");
-        return 0u;
-    }
-
-    return 1u;
-}
+	const game_snapshot_t * snapshot;
 
+	(void)param;
 
-Private void drawRectangleInFrameBuf(int xPos, int yPos, int width, int height, uint16_t color)
-{
-	for (int x = xPos; ((x < (xPos+width)) && (x < 320)); x++)
+	while(1)
 	{
-		for (int y = yPos; ((y < (yPos+height)) && (y < 240)); y++)
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		snapshot = mailbox_take(&priv_snapshot_mailbox);
+		if (snapshot != NULL)
 		{
-			SET_FRAME_BUF_PIXEL(priv_frame_buffer, x, y, color);
+			int64_t frame_start = profiler_start();
+
+			render_drawSnapshot(snapshot, esp_timer_get_time() + (LOGIC_PERIOD_MS * 1000));
+			profiler_record(PROFILER_STAGE_FRAME, frame_start);
 		}
 	}
 }
 
-
-Private void drawBmpInFrameBuf(int xPos, int yPos, int width, int height, uint16_t * data_buf)
+/* Copies the state the render task needs into the mailbox and wakes the render task. */
+Private void publishSnapshot(void)
 {
-	uint16_t * data_ptr = data_buf;
-
-	for (int x = xPos; (x < (xPos + width)); x++)
-	{
-		for (int y = yPos; (y < (yPos + height)); y++)
-		{
-			if ((x >= 0) && (x < DISPLAY_WIDTH) && (y >= 0) && (y < DISPLAY_HEIGHT))
-			{
-				SET_FRAME_BUF_PIXEL(priv_frame_buffer, x, y, *data_ptr);
-			}
-			data_ptr++;
+	game_snapshot_t * snapshot = mailbox_getWriteBuffer(&priv_snapshot_mailbox);
+
+	snapshot->sequence = ++priv_snapshot_sequence;
+	snapshot->scene = priv_scene;
+	snapshot->screen = currentScreen;
+	snapshot->menu_selection = selectedMenuBtn;
+	snapshot->speed = gameSpeed;
+	snapshot->level = level;
+
+	if (currentScreen == SNAPSHOT_SCREEN_GAME) {
+		uint32_t length = snakeBody_getLength(&snake.body);
+
+		memset(snapshot->cells, SNAPSHOT_CELL_EMPTY, sizeof(snapshot->cells));
+		snapshot->cells[positionCell((struct SnakeSegment){ food.x, food.y })] = food.asset;
+		for (uint32_t ix = 1u; ix < length; ix++) {
+			snapshot->cells[snakeBody_getSegment(&snake.body, ix)] = ASSET_SNAKE_BODY;
 		}
+		snapshot->cells[snakeBody_getSegment(&snake.body, 0u)] = ASSET_SNAKE_HEAD;
 	}
-}
-
-
-
-Private void drawSnakeGame(void) {
-	// Draw the background
-	drawBackground();
-	updateSnakePosition();
-	// check for snake collision
-	snakeCollision();
-	if (snake.status != 1) {
-		return;
-	}
-	// Draw the snake
-	drawFood();
-	drawSnake();
-
-
-	// Flush the frame buffer
-	display_drawScreenBuffer(priv_frame_buffer);
-
 
+	mailbox_publish(&priv_snapshot_mailbox);
+	xTaskNotifyGive(priv_render_task);
 }
 
-Private void drawMenu(void){
-
-    printf("Drawing menu...\n");
-
-	// Draw the background
-	drawBackground();
-
-    printf("Drawing menu butoons\n");
-	drawBmpInFrameBuf(50, 50, 100, 40, priv_levelselect1_buffer);
-	drawBmpInFrameBuf(150, 50, 100, 40, priv_levelselect2_buffer);
-	drawBmpInFrameBuf(50, 100, 100, 40, priv_levelselect3_buffer);
-	drawBmpInFrameBuf(150, 100, 100, 40, priv_settingsbtn_buffer);
-
-	
-	display_drawScreenBuffer(priv_frame_buffer);
-}
-
-Private void drawOptions(void){
+Private void logMemoryUsage(void)
+{
+	spritePool_stats_t stats;
 
-	// Draw the background
+	printf("DMA heap free: %u bytes (minimum %u)\n",
+		   (unsigned)heap_caps_get_free_size(MALLOC_CAP_DMA), (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_DMA));
 
-	drawBmpInFrameBuf(100, 50, 100, 40, priv_settings_buffer);
-	
-	display_drawScreenBuffer(priv_frame_buffer);
+	for (int ix = 0; ix < NUMBER_OF_SPRITE_CLASSES; ix++)
+	{
+		spritePool_getStats(ix, &stats);
+		if (stats.slots == 0u)
+		{
+			continue;
+		}
+		printf("Sprite pool %ux%u %u bpp: %u/%u slots in use, %u failed\n",
+			   stats.width, stats.height, stats.bits_per_pixel, stats.in_use, stats.slots, (unsigned)stats.failed_allocs);
+	}
 }
 
-Private void changeMenuSelection(int selectedMenuBtn) {
-	const char* level1path = "/images/lvl1.bmp";
-	const char* level2path = "/images/lvl2.bmp";
-	const char* level3path = "/images/lvl3.bmp";
-	const char* optionsbtnpath = "/images/options.bmp";
-
-
-	if (selectedMenuBtn == 1){
+/* Share of the time since boot that each client held the SPI bus, and how long it waited for it. */
+Private void logBusUsage(void)
+{
+	static const char * const names[NUMBER_OF_SPI_BUS_CLIENTS] = { "display", "SD card", "prefetch" };
+	int64_t uptime_us = esp_timer_get_time();
+	spiBus_stats_t stats;
 
-	    printf("Drawing menu btn 1...\n");
-		level1path = "/images/lvl1h.bmp";
-	} else if (selectedMenuBtn == 2){
-		level2path = "/images/lvl2h.bmp";
-	} else if (selectedMenuBtn == 3){
-		level3path = "/images/lvl3h.bmp";
-	}
-	else if (selectedMenuBtn == 4){
-		optionsbtnpath = "/images/optionsh.bmp";
+	for (int ix = 0; ix < NUMBER_OF_SPI_BUS_CLIENTS; ix++)
+	{
+		spiBus_getStats(ix, &stats);
+		printf("SPI bus %s: %u.%u%% busy, %u holds, wait avg %u us, max %u us, %u late\n", names[ix],
+			   (unsigned)((stats.busy_us * 100) / uptime_us), (unsigned)(((stats.busy_us * 1000) / uptime_us) % 10),
+			   (unsigned)stats.acquisitions,
+			   (unsigned)((stats.acquisitions > 0u) ? (stats.wait_total_us / stats.acquisitions) : 0),
+			   (unsigned)stats.wait_max_us, (unsigned)stats.late);
 	}
+}
 
-	
-	priv_levelselect1_buffer = heap_caps_malloc(100 * 40 * sizeof(uint16_t), MALLOC_CAP_DMA);
-	assert(priv_levelselect1_buffer);
-	sdCard_Read_bmp_file(level1path, priv_levelselect1_buffer);
-
-	priv_levelselect2_buffer = heap_caps_malloc(100 * 40 * sizeof(uint16_t), MALLOC_CAP_DMA);
-	assert(priv_levelselect2_buffer);
-	sdCard_Read_bmp_file(level2path, priv_levelselect2_buffer);
-
-	priv_levelselect3_buffer = heap_caps_malloc(100 * 40 * sizeof(uint16_t), MALLOC_CAP_DMA);
-	assert(priv_levelselect3_buffer);
-	sdCard_Read_bmp_file(level3path, priv_levelselect3_buffer);
+/* Time from the stick crossing its threshold, or the button closing, to the game acting on it. */
+Private void logInputStats(void)
+{
+	input_stats_t stats;
 
-	priv_settingsbtn_buffer = heap_caps_malloc(100 * 40 * sizeof(uint16_t), MALLOC_CAP_DMA);
-	assert(priv_settingsbtn_buffer);
-	sdCard_Read_bmp_file(optionsbtnpath, priv_settingsbtn_buffer);
+	input_getStats(&stats);
+	printf("Input: %u events, latency avg %u us, max %u us, %u dropped\n", (unsigned)stats.events,
+		   (unsigned)((stats.events > 0u) ? (stats.latency_total_us / stats.events) : 0), (unsigned)stats.latency_max_us,
+		   (unsigned)stats.dropped);
 }
 
-Private struct intTriple handleInputs(void) {
-	int joystick_x = adc1_get_raw(ADC1_CHANNEL_2);
-	int joystick_y = adc1_get_raw(ADC1_CHANNEL_7);
-	int joystick_btn = gpio_get_level(GPIO_NUM_18);
-	struct intTriple returnValues = {joystick_x, joystick_y, joystick_btn};
-	return returnValues;
 
+/* One logic tick. The render task works out what to redraw from the snapshot. */
+Private void stepSnakeGame(void) {
+	updateSnakePosition();
+	// check for snake collision
+	snakeCollision();
 }
 
-Private void moveSnake(struct intTriple returnValues) {
-	int joystick_x = returnValues.a;
-	int joystick_y = returnValues.b;
-	if (joystick_x > 4000 && snake.direction != RIGHT) {
+Private void moveSnake(input_event_type_t input) {
+	if (input == INPUT_EVENT_LEFT && snake.direction != RIGHT) {
 		snake.direction = LEFT;
-	} else if (joystick_x < 10 && snake.direction != LEFT) {
+	} else if (input == INPUT_EVENT_RIGHT && snake.direction != LEFT) {
 		snake.direction = RIGHT;
-	} if (joystick_y > 4000 && snake.direction != UP) {
+	} else if (input == INPUT_EVENT_DOWN && snake.direction != UP) {
 		snake.direction = DOWN;
-	} else if (joystick_y < 10 && snake.direction != DOWN) {
+	} else if (input == INPUT_EVENT_UP && snake.direction != DOWN) {
 		snake.direction = UP;
 	}
 }
 
-TickType_t lastRenderTicks = 0;
-
 Private void gameLoop(void) {
+	input_event_t input;
+	uint32_t ticks;
 
-	if (xTaskGetTickCount() - lastRenderTicks > 40) {	
-		drawSnakeGame();
-		
-		if (level == 2){
-			drawEnginaator();	
-		} else if (level == 3){
-			// OMALOOMING
-		}
-		lastRenderTicks = xTaskGetTickCount();
+	while (replay_getEvent(&input)) {
+		moveSnake(input.type);
+		input_markHandled(&input);
 	}
-	moveSnake(handleInputs());
-
-}
 
-Private void menuLoop(void) {
+	// The snake steps at the rate set by gameSpeed whatever the frame rate, after a slow frame
+	// the missed steps are run back to back
+	ticks = replay_getSteps(scheduler_update(&priv_game_scheduler, esp_timer_get_time()));
 
-	drawMenu();
-
-	struct intTriple returnValues = handleInputs();
-	int joystick_x = returnValues.a;
-	int joystick_y = returnValues.b;
-	int joystick_btn = returnValues.c;
-	if (joystick_x > 4000 && selectedMenuBtn != 4) {
-		selectedMenuBtn++;
-		changeMenuSelection(selectedMenuBtn);
-	} else if (joystick_x < 10 && selectedMenuBtn != 1) {
-		selectedMenuBtn--;
-		changeMenuSelection(selectedMenuBtn);
-	}
-	if (joystick_btn == 0) {
-		if (selectedMenuBtn != 4) {
-			level = option;
-			currentScreen = SCREEN_GAME;
-			initLevel();
-		}
-		else {
-			currentScreen = SCREEN_SETTINGS;
-		}
-		
+	while ((ticks > 0u) && (snake.status == 1)) {
+		stepSnakeGame();
+		ticks--;
 	}
 }
 
-Private void updateOptionSelection(int option) {
-	const char* optionspath = "/images/speed1.bmp";
-
-	if (option == 2){
-		const char* optionspath = "/images/speed2.bmp";
-	} else if (option == 3){
-		const char* optionspath = "/images/speed3.bmp";
+Private void menuLoop(void) {
+	input_event_t input;
+
+	// Events after a press are left in the queue for the screen it opens
+	while (currentScreen == SNAPSHOT_SCREEN_MAIN_MENU && replay_getEvent(&input)) {
+		if (input.type == INPUT_EVENT_LEFT && selectedMenuBtn != 4) {
+			selectedMenuBtn++;
+		} else if (input.type == INPUT_EVENT_RIGHT && selectedMenuBtn != 1) {
+			selectedMenuBtn--;
+		} else if (input.type == INPUT_EVENT_PRESS) {
+			if (selectedMenuBtn != 4) {
+				level = selectedMenuBtn;
+				currentScreen = SNAPSHOT_SCREEN_GAME;
+				initLevel();
+			}
+			else {
+				currentScreen = SNAPSHOT_SCREEN_SETTINGS;
+			}
+		}
+		input_markHandled(&input);
 	}
-
-	priv_settings_buffer = heap_caps_malloc(100 * 20 * sizeof(uint16_t), MALLOC_CAP_DMA);
-	assert(priv_settings_buffer);
-	sdCard_Read_bmp_file(optionspath, priv_settings_buffer);
 }
 
 Private void optionsLoop(void) {
-
-	struct intTriple returnValues = handleInputs();
-	int joystick_x = returnValues.a;
-	int joystick_y = returnValues.b;
-	int joystick_btn = returnValues.c;
-	if (joystick_x > 4000 && gameSpeed != 3) {
-		gameSpeed++;
-		updateOptionSelection(gameSpeed);
-	} else if (joystick_x < 10 && gameSpeed != 1) {
-		gameSpeed--;
-		updateOptionSelection(gameSpeed);
-	}
-	if (joystick_btn == 1) {
-		currentScreen = SCREEN_MAIN_MENU;
-	}
-
-	drawOptions();
-}
-
-Private void drawBackground(void) {
-	// Draw the background
-	drawRectangleInFrameBuf(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, COLOR_WHITE);
-}
-
-Private void drawSnake(void) {
-
-    // Clear previous snake position
-/* 	drawRectangleInFrameBuf(snake.body[snake.length - 1].x, snake.body[snake.length - 1].y, GRID_WIDTH, GRID_HEIGHT, COLOR_WHITE); */
-    // Update snake position
-	for (int i = snake.length - 1; i > 0; i--) {
-		snake.body[i].x = snake.body[i - 1].x;
-		snake.body[i].y = snake.body[i - 1].y;
+	input_event_t input;
+
+	while (currentScreen == SNAPSHOT_SCREEN_SETTINGS && replay_getEvent(&input)) {
+		if (input.type == INPUT_EVENT_LEFT && gameSpeed != 3) {
+			gameSpeed++;
+		} else if (input.type == INPUT_EVENT_RIGHT && gameSpeed != 1) {
+			gameSpeed--;
+		} else if (input.type == INPUT_EVENT_PRESS) {
+			currentScreen = SNAPSHOT_SCREEN_MAIN_MENU;
+		}
+		input_markHandled(&input);
 	}
-
-
-
 }
 
 Private void updateSnakePosition(void) {
     if (snake.direction == RIGHT) {
-        snake.body[0].x += 20;
+        snake.head.x += 20;
     } else if (snake.direction == DOWN) {
-        snake.body[0].y += 20;
+        snake.head.y += 20;
     } else if (snake.direction == LEFT) {
-        snake.body[0].x -= 20;
+        snake.head.x -= 20;
     } else if (snake.direction == UP) {
-        snake.body[0].y -= 20;
-    }
-    // Draw the snake at its new position
-    for (int i = 0; i < snake.length; i++) {
-		if (i == 0){
-        	drawBmpInFrameBuf(snake.body[i].x, snake.body[i].y, GRID_WIDTH, GRID_HEIGHT, priv_snake_buffer);
-		} else {
-			drawBmpInFrameBuf(snake.body[i].x, snake.body[i].y, GRID_WIDTH, GRID_HEIGHT, priv_snake_body_buffer);
-		}
+        snake.head.y -= 20;
     }
+
+	// Walls and the edge of the board are one bit test, snakeCollision() ends the game on them
+	snake.hitWall = level_isSolid(priv_level, snake.head.x / GRID_WIDTH, snake.head.y / GRID_HEIGHT);
+	if (snake.hitWall) {
+		return;
+	}
+
+	// The tail leaves its cell, unless snakeEat() grows the snake back onto it
+	snake.hitItself = !snakeBody_move(&snake.body, positionCell(snake.head));
 }
 
-Private void foodSpawn(void) {
+Private struct SnakeSegment cellPosition(grid_cell_t cell) {
+	struct SnakeSegment position = { GRID_CELL_COLUMN(cell) * GRID_WIDTH, GRID_CELL_ROW(cell) * GRID_HEIGHT };
+	return position;
+}
 
-	food.x = (rand() % (DISPLAY_WIDTH / GRID_WIDTH))*GRID_WIDTH;
-	food.y = (rand() % (DISPLAY_HEIGHT / GRID_HEIGHT))*GRID_HEIGHT;
+Private grid_cell_t positionCell(struct SnakeSegment position) {
+	return GRID_CELL(position.x / GRID_WIDTH, position.y / GRID_HEIGHT);
+}
 
-    // Select a random food type
-    int randomFoodType = rand() % 6;
+/* Places the food on a random cell the snake does not cover. Returns false if there is none left. */
+Private bool foodSpawn(void) {
+	const freeCells_t * freeCells = snakeBody_getFreeCells(&snake.body);
+	struct SnakeSegment position;
 
-    // Get the file path for the selected food type
-    switch (randomFoodType) {
-        case 1:
-            food.foodFilePath = "/images/apple.bmp";
-            break;
-        case 2:
-            food.foodFilePath = "/images/cherry.bmp";
-            break;
-        case 3:
-            food.foodFilePath = "/images/grapes.bmp";
-            break;
-		case 4:
-			food.foodFilePath = "/images/pineapple.bmp";
-			break;
-		case 5:
-			food.foodFilePath = "/images/tomato.bmp";
-			break;
-		case 6:
-			food.foodFilePath = "/images/watermelon.bmp";
-			break;
-		default:
-			food.foodFilePath = "/images/apple.bmp";
-			break;
-    }
+	if (freeCells_getCount(freeCells) == 0) {
+		return false;
+	}
 
-    priv_food_buffer = heap_caps_malloc(GRID_HEIGHT * GRID_WIDTH * sizeof(uint16_t), MALLOC_CAP_DMA);
-	assert(priv_food_buffer);
-	sdCard_Read_bmp_file(food.foodFilePath, priv_food_buffer);
-}
-Private void drawFood(void){
-	drawBmpInFrameBuf(food.x, food.y, GRID_WIDTH, GRID_HEIGHT, priv_food_buffer);
+	position = cellPosition(freeCells_get(freeCells, gameRandom_below(&priv_random, freeCells_getCount(freeCells))));
+	food.x = position.x;
+	food.y = position.y;
+
+    // Select a random food type
+    food.asset = ASSET_FIRST_FOOD + gameRandom_below(&priv_random, NUMBER_OF_FOODS);
+	return true;
 }
 
 Private void snakeEat(void) {
-	// Increase the length of the snake
-	snake.length += 1;
-
-	// Add a new segment to the snake
-	snake.body[snake.length - 1].x = snake.body[snake.length - 2].x;
-	snake.body[snake.length - 1].y = snake.body[snake.length - 2].y;
+	// The new segment stays on the cell the tail just left
+	(void)snakeBody_grow(&snake.body);
 }
 
 Private void initLevel(void) {
 	//set speed
-	const TickType_t xFrequency = (40u / portTICK_PERIOD_MS) * gameSpeed;
+	scheduler_start(&priv_game_scheduler, (GAME_STEP_PERIOD_MS * 1000) / gameSpeed, esp_timer_get_time());
+
+	priv_level = level_get(level);
 
 	// Reset the snake
 	snake.status = 1;
-	snake.length = 1;
-	snake.body[0].x = (rand() % (DISPLAY_WIDTH / GRID_WIDTH))*GRID_WIDTH;
-	snake.body[0].y = (rand() % (DISPLAY_HEIGHT / GRID_HEIGHT))*GRID_HEIGHT;
+	snake.hitWall = false;
+	snake.hitItself = false;
+	snake.head = cellPosition(level_pickSpawn(priv_level, &priv_random));
+	snakeBody_reset(&snake.body, positionCell(snake.head));
+
+	// No food on the walls
+	for (grid_cell_t cell = 0; cell < GRID_CELLS; cell++) {
+		if (level_isSolid(priv_level, GRID_CELL_COLUMN(cell), GRID_CELL_ROW(cell))) {
+			snakeBody_block(&snake.body, cell);
+		}
+	}
 
-	snake.direction = RIGHT;
+	// The level directions are in the same order
+	snake.direction = (enum Direction)priv_level->direction;
 
     foodSpawn();
-}
 
-Private void drawEnginaator(void) {
-	priv_enginaator_buffer = heap_caps_malloc(156*40*sizeof(uint16_t), MALLOC_CAP_DMA);
-    assert(priv_enginaator_buffer);
-    sdCard_Read_bmp_file("/enginaator.bmp", priv_enginaator_buffer);
-	drawBmpInFrameBuf((DISPLAY_WIDTH/2)-156/2, (DISPLAY_HEIGHT/2)-40/2, 156, 40, priv_enginaator_buffer);
+	// New level, the render task draws it from scratch
+	priv_scene++;
 }
 
 Private void snakeDie(void) {
 	snake.status = 0;
-	currentScreen = SCREEN_MAIN_MENU;
+	currentScreen = SNAPSHOT_SCREEN_MAIN_MENU;
 	printf("Snake ded\n");
+	logGameStats();
+	logInputStats();
+	replay_flush();
+}
+
+/* The snake covers the whole board, there is nowhere left to put food. */
+Private void snakeWin(void) {
+	snake.status = 0;
+	currentScreen = SNAPSHOT_SCREEN_MAIN_MENU;
+	printf("Board full, snake wins\n");
+	logGameStats();
+	replay_flush();
+}
+
+Private void logGameStats(void) {
+	const scheduler_stats_t * stats = scheduler_getStats(&priv_game_scheduler);
+
+	printf("Game steps: %u run, %u missed, %u late frames\n",
+		   (unsigned)stats->ticks, (unsigned)stats->missed_ticks, (unsigned)stats->late_frames);
 }
 
 Private void snakeCollision(void) {
 
-	// Check if the snake has collided with the walls
-	if (snake.body[0].x < 0 || snake.body[0].x >= DISPLAY_WIDTH || snake.body[0].y < 0 || snake.body[0].y >= DISPLAY_HEIGHT) {
+	// Check if the snake has collided with the walls, updateSnakePosition() found out while moving it
+	if (snake.hitWall) {
 		snakeDie();
 	}
-	else if (level == 2 && (snake.body[0].x < (DISPLAY_WIDTH/2)-156/2 || snake.body[0].x >= (DISPLAY_WIDTH/2)+156/2 || snake.body[0].y < (DISPLAY_HEIGHT/2)-40/2 || snake.body[0].y >= (DISPLAY_HEIGHT/2)+40/2)){
+	// Check if the snake has collided with itself, updateSnakePosition() found out while moving it
+	else if (snake.hitItself) {
 		snakeDie();
 	}
-
-	// Check if the snake has collided with itself
-	for (int i = 1; i < snake.length; i++) {
-		if (snake.body[0].x == snake.body[i].x && snake.body[0].y == snake.body[i].y) {
-			snakeDie();
-		}
-	}
-	if (snake.body[0].x == food.x && snake.body[0].y == food.y){
-		foodSpawn();
+	else if (snake.head.x == food.x && snake.head.y == food.y){
+		// Grow first, so the new food cannot land on the new segment
 		snakeEat();
-
 		printf("Snake eat\n");
+
+		if (!foodSpawn()) {
+			snakeWin();
+		}
 	}
 }
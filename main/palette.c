@@ -0,0 +1,253 @@
+/*
+ * palette.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <string.h>
+
+#include "blit.h"
+#include "palette.h"
+
+/*
+ * Turns RGB565 images into the indexed bitmaps blit_copyIndexed() draws. The palette is made of
+ * the most frequent colours of the image, so an image with no more colours than the palette has
+ * entries comes out exactly as it was. The rest of the colours get the nearest palette entry.
+ */
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+#define PALETTE_NO_INDEX    0xFFFFu
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static int find_entry(const palette_histogram_t * histogram, uint16_t color, bool add);
+static uint8_t nearest_index(const uint16_t * palette, uint32_t first, uint32_t count, uint16_t color);
+static uint32_t color_distance(uint16_t a, uint16_t b);
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+/* Returns how many colours the width x height pixels have, not counting the key colour of a keyed
+ * image. An image with more than PALETTE_HISTOGRAM_SIZE colours counts as one more than that. */
+uint32_t palette_countColors(const uint16_t * pixels, uint16_t width, uint16_t height, bool keyed, uint16_t key,
+                             palette_histogram_t * histogram)
+{
+    uint32_t colors = 0u;
+
+    memset(histogram->count, 0, sizeof(histogram->count));
+
+    for (uint32_t ix = 0u; ix < (uint32_t)width * height; ix++)
+    {
+        int entry;
+
+        if (keyed && (pixels[ix] == key))
+        {
+            continue;
+        }
+
+        entry = find_entry(histogram, pixels[ix], true);
+        if (entry < 0)
+        {
+            return PALETTE_HISTOGRAM_SIZE + 1u;
+        }
+        if (histogram->count[entry] == 0u)
+        {
+            histogram->color[entry] = pixels[ix];
+            histogram->count[entry] = 1u;
+            colors++;
+        }
+    }
+
+    return colors;
+}
+
+
+/* Fills palette, 1 << bits_per_pixel entries, and the indexed bitmap of the width x height pixels.
+ * In a keyed image the key colour gets index 0 and no other colour does. Returns the number of
+ * pixels that did not keep their exact colour. */
+uint32_t palette_quantize(const uint16_t * pixels, uint16_t width, uint16_t height, uint8_t bits_per_pixel,
+                          bool keyed, uint16_t key, uint16_t * palette, uint8_t * indices,
+                          palette_histogram_t * histogram)
+{
+    uint32_t entries = BLIT_PALETTE_ENTRIES(bits_per_pixel);
+    uint32_t first = keyed ? 1u : 0u;
+    uint32_t used = first;
+    uint32_t row_bytes = BLIT_INDEXED_ROW_BYTES(width, bits_per_pixel);
+    uint32_t changed = 0u;
+
+    memset(histogram->count, 0, sizeof(histogram->count));
+
+    for (uint32_t ix = 0u; ix < (uint32_t)width * height; ix++)
+    {
+        int entry = find_entry(histogram, pixels[ix], true);
+
+        if ((entry >= 0) && (histogram->count[entry] < UINT16_MAX))
+        {
+            histogram->color[entry] = pixels[ix];
+            histogram->count[entry]++;
+            histogram->index[entry] = PALETTE_NO_INDEX;
+        }
+    }
+
+    memset(palette, 0, entries * sizeof(uint16_t));
+    if (keyed)
+    {
+        int entry = find_entry(histogram, key, false);
+
+        palette[0] = key;
+        if (entry >= 0)
+        {
+            histogram->index[entry] = 0u;
+        }
+    }
+
+    /* Most frequent first, until the palette is full or every colour has an entry. */
+    while (used < entries)
+    {
+        int best = -1;
+
+        for (int entry = 0; entry < (int)PALETTE_HISTOGRAM_SIZE; entry++)
+        {
+            if ((histogram->count[entry] > 0u) && (histogram->index[entry] == PALETTE_NO_INDEX) &&
+                ((best < 0) || (histogram->count[entry] > histogram->count[best])))
+            {
+                best = entry;
+            }
+        }
+
+        if (best < 0)
+        {
+            break;
+        }
+
+        histogram->index[best] = (uint16_t)used;
+        palette[used++] = histogram->color[best];
+    }
+
+    for (uint16_t y = 0u; y < height; y++)
+    {
+        uint8_t * row = &indices[y * row_bytes];
+
+        memset(row, 0, row_bytes);
+
+        for (uint16_t x = 0u; x < width; x++)
+        {
+            uint16_t color = pixels[(y * width) + x];
+            int entry = find_entry(histogram, color, false);
+            uint8_t index;
+
+            if (keyed && (color == key))
+            {
+                index = 0u;
+            }
+            else if ((entry >= 0) && (histogram->index[entry] != PALETTE_NO_INDEX))
+            {
+                index = (uint8_t)histogram->index[entry];
+            }
+            else
+            {
+                index = nearest_index(palette, first, used - first, color);
+                if (entry >= 0)
+                {
+                    histogram->index[entry] = index;
+                }
+            }
+
+            if (palette[index] != color)
+            {
+                changed++;
+            }
+
+            if (bits_per_pixel == 4u)
+            {
+                row[x >> 1] |= (uint8_t)(index << (((~x) & 1u) << 2));
+            }
+            else
+            {
+                row[x] = index;
+            }
+        }
+    }
+
+    return changed;
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+/* Open addressing with linear probing. Returns the entry of color, or with add a free entry for it,
+ * or -1 if it is not there and the table is full. */
+static int find_entry(const palette_histogram_t * histogram, uint16_t color, bool add)
+{
+    uint32_t slot = ((uint32_t)color * 40503u) >> 6;
+
+    for (uint32_t probe = 0u; probe < PALETTE_HISTOGRAM_SIZE; probe++)
+    {
+        uint32_t entry = (slot + probe) & (PALETTE_HISTOGRAM_SIZE - 1u);
+
+        if (histogram->count[entry] == 0u)
+        {
+            return add ? (int)entry : -1;
+        }
+
+        if (histogram->color[entry] == color)
+        {
+            return (int)entry;
+        }
+    }
+
+    return -1;
+}
+
+
+static uint8_t nearest_index(const uint16_t * palette, uint32_t first, uint32_t count, uint16_t color)
+{
+    uint32_t best = first;
+    uint32_t best_distance = UINT32_MAX;
+
+    for (uint32_t ix = first; ix < (first + count); ix++)
+    {
+        uint32_t distance = color_distance(palette[ix], color);
+
+        if (distance < best_distance)
+        {
+            best = ix;
+            best_distance = distance;
+        }
+    }
+
+    return (uint8_t)best;
+}
+
+
+/* Squared distance of two colours in the display's byte order, red and blue scaled to 6 bits like green. */
+static uint32_t color_distance(uint16_t a, uint16_t b)
+{
+    uint16_t sa = (uint16_t)((a >> 8) | (a << 8));
+    uint16_t sb = (uint16_t)((b >> 8) | (b << 8));
+    int dr = (int)((sa >> 11) - (sb >> 11)) * 2;
+    int dg = (int)((sa >> 5) & 0x3Fu) - (int)((sb >> 5) & 0x3Fu);
+    int db = (int)((sa & 0x1Fu) - (sb & 0x1Fu)) * 2;
+
+    return (uint32_t)((dr * dr) + (dg * dg) + (db * db));
+}
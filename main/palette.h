@@ -0,0 +1,31 @@
+/*
+ * palette.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_PALETTE_H_
+#define MAIN_PALETTE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Distinct colours an image can have for all of them to be counted. Colours beyond this are
+ * mapped to the nearest colour of the palette. */
+#define PALETTE_HISTOGRAM_SIZE  1024u
+
+/* Work space of palette_quantize(). Too big for a task stack, so the caller provides it. */
+typedef struct
+{
+    uint16_t color[PALETTE_HISTOGRAM_SIZE];
+    uint16_t count[PALETTE_HISTOGRAM_SIZE];     /* 0 for a free entry */
+    uint16_t index[PALETTE_HISTOGRAM_SIZE];     /* Palette index of the colour, or PALETTE_NO_INDEX */
+} palette_histogram_t;
+
+extern uint32_t palette_countColors(const uint16_t * pixels, uint16_t width, uint16_t height, bool keyed, uint16_t key,
+                                    palette_histogram_t * histogram);
+extern uint32_t palette_quantize(const uint16_t * pixels, uint16_t width, uint16_t height, uint8_t bits_per_pixel,
+                                 bool keyed, uint16_t key, uint16_t * palette, uint8_t * indices,
+                                 palette_histogram_t * histogram);
+
+#endif /* MAIN_PALETTE_H_ */
@@ -0,0 +1,214 @@
+/*
+ * profiler.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/param.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+#include "profiler.h"
+
+/*
+ * Every stage records how long it took into a ring of the most recent samples. Recording is a
+ * timer read and a store, the statistics are only worked out when they are asked for. Stages are
+ * recorded from the task that runs them, so a stage's start and end are always on the same task.
+ */
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+/* Type 'p' and enter on the serial console for a report. */
+#define PROFILER_REPORT_KEY 'p'
+
+/*
+**====================================================================================
+** Private type definitions
+**====================================================================================
+*/
+
+typedef struct
+{
+    uint32_t samples[PROFILER_RING_SIZE];
+    uint32_t count;
+} stage_ring_t;
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static void sort_samples(uint32_t * samples, uint32_t count);
+
+/*
+**====================================================================================
+** Private variable declarations
+**====================================================================================
+*/
+
+static portMUX_TYPE priv_lock = portMUX_INITIALIZER_UNLOCKED;
+static stage_ring_t priv_stages[NUMBER_OF_PROFILER_STAGES];
+static uint32_t priv_frame_budget_us;
+static uint32_t priv_overruns;
+
+static const char * const priv_stage_names[NUMBER_OF_PROFILER_STAGES] =
+{
+    "input", "sim", "raster", "flush", "sd", "frame"
+};
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+void profiler_init(uint32_t frame_budget_us)
+{
+    priv_frame_budget_us = frame_budget_us;
+}
+
+
+/* Timestamp for profiler_record(). */
+int64_t profiler_start(void)
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    /* On the host the simulated clock only moves while a task waits, the work itself takes no
+     * simulated time. The thread's own CPU time stands in for it. */
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return esp_timer_get_time() + ((int64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+#endif
+}
+
+
+/* Records the time since start, which came from profiler_start() on the same task. */
+void profiler_record(profiler_stage_t stage, int64_t start)
+{
+    uint32_t elapsed_us = (uint32_t)(profiler_start() - start);
+    stage_ring_t * ring = &priv_stages[stage];
+
+    portENTER_CRITICAL(&priv_lock);
+    ring->samples[ring->count % PROFILER_RING_SIZE] = elapsed_us;
+    ring->count++;
+    if ((stage == PROFILER_STAGE_FRAME) && (elapsed_us > priv_frame_budget_us))
+    {
+        priv_overruns++;
+    }
+    portEXIT_CRITICAL(&priv_lock);
+}
+
+
+void profiler_getSummary(profiler_stage_t stage, profiler_summary_t * summary)
+{
+    uint32_t samples[PROFILER_RING_SIZE];
+    uint32_t count;
+    uint64_t total = 0u;
+
+    portENTER_CRITICAL(&priv_lock);
+    summary->count = priv_stages[stage].count;
+    count = MIN(summary->count, PROFILER_RING_SIZE);
+    memcpy(samples, priv_stages[stage].samples, count * sizeof(uint32_t));
+    portEXIT_CRITICAL(&priv_lock);
+
+    if (count == 0u)
+    {
+        summary->min_us = summary->avg_us = summary->p99_us = summary->max_us = 0u;
+        return;
+    }
+
+    sort_samples(samples, count);
+
+    for (uint32_t ix = 0u; ix < count; ix++)
+    {
+        total += samples[ix];
+    }
+
+    summary->min_us = samples[0];
+    summary->avg_us = (uint32_t)(total / count);
+    summary->p99_us = samples[((count * 99u) - 1u) / 100u];
+    summary->max_us = samples[count - 1u];
+}
+
+
+/* Frames that took longer than the budget since boot. */
+uint32_t profiler_getOverruns(void)
+{
+    return priv_overruns;
+}
+
+
+void profiler_report(void)
+{
+    profiler_summary_t summary;
+
+    printf("Profile (us, last %u samples)   count    min    avg    p99    max\n", (unsigned)PROFILER_RING_SIZE);
+
+    for (int ix = 0; ix < NUMBER_OF_PROFILER_STAGES; ix++)
+    {
+        profiler_getSummary(ix, &summary);
+        printf("  %-28s %7u %6u %6u %6u %6u\n", priv_stage_names[ix], (unsigned)summary.count,
+               (unsigned)summary.min_us, (unsigned)summary.avg_us, (unsigned)summary.p99_us, (unsigned)summary.max_us);
+    }
+
+    printf("  %u frames over the %u us budget\n", (unsigned)profiler_getOverruns(), (unsigned)priv_frame_budget_us);
+}
+
+
+/* Prints the report if it was asked for on the console. Never blocks, the console is read
+ * without waiting. */
+void profiler_pollConsole(void)
+{
+    int c;
+
+    while ((c = getchar()) != EOF)
+    {
+        if (c == PROFILER_REPORT_KEY)
+        {
+            profiler_report();
+        }
+    }
+
+    clearerr(stdin);
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+/* Insertion sort, the ring is short and this only runs for a report. */
+static void sort_samples(uint32_t * samples, uint32_t count)
+{
+    for (uint32_t ix = 1u; ix < count; ix++)
+    {
+        uint32_t value = samples[ix];
+        uint32_t pos = ix;
+
+        while ((pos > 0u) && (samples[pos - 1u] > value))
+        {
+            samples[pos] = samples[pos - 1u];
+            pos--;
+        }
+
+        samples[pos] = value;
+    }
+}
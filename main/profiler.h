@@ -0,0 +1,44 @@
+/*
+ * profiler.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_PROFILER_H_
+#define MAIN_PROFILER_H_
+
+#include <stdint.h>
+
+/* The most recent samples of each stage are kept for the report. */
+#define PROFILER_RING_SIZE 128u
+
+typedef enum
+{
+    PROFILER_STAGE_INPUT,       /* Turning a frame of ADC samples into events, in the input task */
+    PROFILER_STAGE_SIMULATION,  /* One logic tick, including publishing the snapshot */
+    PROFILER_STAGE_RASTER,      /* Drawing a snapshot into the frame buffer or the display list */
+    PROFILER_STAGE_FLUSH,       /* Waiting for the SPI bus and sending the frame until it is on the panel */
+    PROFILER_STAGE_SD,          /* One SD card read or write, including waiting for the bus */
+    PROFILER_STAGE_FRAME,       /* Raster and flush of one frame, checked against the budget */
+
+    NUMBER_OF_PROFILER_STAGES
+} profiler_stage_t;
+
+typedef struct
+{
+    uint32_t count;             /* Since boot */
+    uint32_t min_us;            /* The rest are over the samples in the ring */
+    uint32_t avg_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} profiler_summary_t;
+
+extern void profiler_init(uint32_t frame_budget_us);
+extern int64_t profiler_start(void);
+extern void profiler_record(profiler_stage_t stage, int64_t start);
+extern void profiler_getSummary(profiler_stage_t stage, profiler_summary_t * summary);
+extern uint32_t profiler_getOverruns(void);
+extern void profiler_report(void);
+extern void profiler_pollConsole(void);
+
+#endif /* MAIN_PROFILER_H_ */
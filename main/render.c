@@ -0,0 +1,366 @@
+/*
+ * render.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+
+#include "display.h"
+#include "assets.h"
+/* With CONFIG_ENGINAATOR_STRIP_RENDERER there is no frame buffer, drawing goes into a display list instead. */
+#include "displayList.h"
+#include "blit.h"
+#include "spiBus.h"
+#include "profiler.h"
+#include "level.h"
+#include "ui.h"
+#include "render.h"
+
+/*
+ * Everything that draws runs in the render task and works only from the snapshots the logic task
+ * publishes. The snapshot that was drawn last is kept, so a game frame only redraws the grid cells
+ * whose contents differ from it. The menu and settings screens are retained widgets that send only
+ * what changed, straight to the panel, see ui.c.
+ *
+ * The background of a level is rasterized once, when the level is first drawn, into a cache of
+ * cell sized tiles. Cells that look the same (plain ones of the same tile) share a tile, every cell
+ * with a part of an image gets its own. Restoring the background of a cell is then one copy.
+ */
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+#define GRID_WIDTH 20
+#define GRID_HEIGHT 20
+
+/* Tiles in the background cache. A level that needs more has the rest of its cells drawn from the
+ * level's tiles every time. */
+#define BACKGROUND_CACHE_TILES  32u
+#define BACKGROUND_TILE_PIXELS  (GRID_WIDTH * GRID_HEIGHT)
+#define BACKGROUND_NOT_CACHED   0xFFu
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static void drawRectangleInFrameBuf(int xPos, int yPos, int width, int height, uint16_t color);
+static void drawSpriteInFrameBuf(int xPos, int yPos, asset_handle_t handle);
+static void drawSpritePartInFrameBuf(int xPos, int yPos, asset_handle_t handle, int clipX, int clipY, int clipWidth, int clipHeight);
+static void presentFrame(int64_t deadline_us);
+static void drawUi(int64_t deadline_us);
+static void drawLevel(const game_snapshot_t * snapshot);
+static void drawChangedCells(const game_snapshot_t * snapshot);
+static void drawBackgroundCell(const level_t * level, grid_cell_t cell);
+static void drawBackgroundTile(const blit_surface_t * surface, const level_t * level, grid_cell_t cell);
+static void buildBackgroundCache(uint8_t level_number);
+
+/*
+**====================================================================================
+** Private variable declarations
+**====================================================================================
+*/
+
+#ifndef CONFIG_ENGINAATOR_STRIP_RENDERER
+static uint16_t * priv_frame_buffer;
+static blit_surface_t priv_frame_surface;
+#endif
+
+/* The background tiles of priv_background_level, and the tile of each cell */
+static uint16_t * priv_background_tiles;
+static uint8_t priv_background_map[GRID_CELLS];
+static uint8_t priv_background_level = 0u;
+
+/* What is on the screen */
+static game_snapshot_t priv_drawn;
+static bool priv_have_drawn = false;
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+void render_init(void)
+{
+#ifndef CONFIG_ENGINAATOR_STRIP_RENDERER
+	/*Allocate memory for the frame buffer from the heap. */
+    priv_frame_buffer = heap_caps_malloc(240*320*sizeof(uint16_t), MALLOC_CAP_DMA);
+    assert(priv_frame_buffer);
+    priv_frame_surface = (blit_surface_t){ .pixels = priv_frame_buffer, .width = DISPLAY_WIDTH, .height = DISPLAY_HEIGHT, .stride = DISPLAY_WIDTH };
+#endif
+
+    priv_background_tiles = heap_caps_malloc(BACKGROUND_CACHE_TILES * BACKGROUND_TILE_PIXELS * sizeof(uint16_t), MALLOC_CAP_8BIT);
+    assert(priv_background_tiles);
+
+    ui_init();
+}
+
+
+/* Brings the screen up to date with the snapshot and sends what changed to the display. The
+ * deadline is when the frame should be on the panel, see spiBus_acquire(). */
+void render_drawSnapshot(const game_snapshot_t * snapshot, int64_t deadline_us)
+{
+	int64_t stage_start;
+
+	ui_update(snapshot);
+
+	if (snapshot->screen != SNAPSHOT_SCREEN_GAME) {
+		drawUi(deadline_us);
+		priv_drawn = *snapshot;
+		priv_have_drawn = true;
+		return;
+	}
+
+	stage_start = profiler_start();
+
+	if (priv_have_drawn && (priv_drawn.screen == SNAPSHOT_SCREEN_GAME) && (priv_drawn.scene == snapshot->scene)) {
+		drawChangedCells(snapshot);
+	}
+	else {
+		drawLevel(snapshot);
+	}
+
+	profiler_record(PROFILER_STAGE_RASTER, stage_start);
+
+	/* The strip renderer rasterizes each strip while the previous one is sent, that work is
+	 * counted in the flush. */
+	stage_start = profiler_start();
+	presentFrame(deadline_us);
+	profiler_record(PROFILER_STAGE_FLUSH, stage_start);
+
+	priv_drawn = *snapshot;
+	priv_have_drawn = true;
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+static void drawRectangleInFrameBuf(int xPos, int yPos, int width, int height, uint16_t color)
+{
+#ifdef CONFIG_ENGINAATOR_STRIP_RENDERER
+	displayList_addFill(xPos, yPos, width, height, color);
+#else
+	blit_fill(&priv_frame_surface, xPos, yPos, width, height, color);
+#endif
+}
+
+
+/* Keyed sprites are drawn over what is already there, so callers restore the cell first. */
+static void drawSpriteInFrameBuf(int xPos, int yPos, asset_handle_t handle)
+{
+	drawSpritePartInFrameBuf(xPos, yPos, handle, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+}
+
+
+/* Draws only the part of the sprite that falls inside the clip rectangle. Indexed sprites are
+ * expanded to RGB565 on the way, in the frame buffer or in the transfer strips, and keyed ones
+ * with a run table skip their transparent pixels without reading them. */
+static void drawSpritePartInFrameBuf(int xPos, int yPos, asset_handle_t handle, int clipX, int clipY, int clipWidth, int clipHeight)
+{
+#ifdef CONFIG_ENGINAATOR_STRIP_RENDERER
+	const asset_sprite_t * sprite = assets_get(handle);
+
+	if (sprite->runs != NULL)
+	{
+		displayList_addRunBitmap(xPos, yPos, sprite->width, sprite->height, sprite->pixels, sprite->bits_per_pixel,
+								 sprite->palette, sprite->runs, clipX, clipY, clipWidth, clipHeight);
+	}
+	else if (sprite->palette != NULL)
+	{
+		displayList_addIndexedBitmap(xPos, yPos, sprite->width, sprite->height, sprite->pixels, sprite->bits_per_pixel,
+									 sprite->palette, sprite->keyed, clipX, clipY, clipWidth, clipHeight);
+	}
+	else if (sprite->keyed)
+	{
+		displayList_addKeyedBitmap(xPos, yPos, sprite->width, sprite->height, sprite->pixels, ASSET_COLOR_KEY,
+								   clipX, clipY, clipWidth, clipHeight);
+	}
+	else
+	{
+		displayList_addBitmap(xPos, yPos, sprite->width, sprite->height, sprite->pixels, clipX, clipY, clipWidth, clipHeight);
+	}
+#else
+	blit_rect_t clip = { clipX, clipY, clipWidth, clipHeight };
+
+	assets_draw(&priv_frame_surface, xPos, yPos, handle, &clip);
+#endif
+}
+
+
+/* Sends the dirty cells to the display. The bus is held until the last strip is out, so an SD read
+ * cannot stall the flush halfway. */
+static void presentFrame(int64_t deadline_us)
+{
+	spiBus_acquire(SPI_BUS_CLIENT_DISPLAY, deadline_us);
+#ifdef CONFIG_ENGINAATOR_STRIP_RENDERER
+	displayList_present();
+#else
+	display_present(priv_frame_buffer);
+#endif
+	display_waitIdle();
+	spiBus_release(SPI_BUS_CLIENT_DISPLAY);
+}
+
+
+/* Sends the widgets that changed, if any, an idle menu does not touch the bus. The widgets are
+ * small enough to be drawn and sent one at a time, which counts as the flush. */
+static void drawUi(int64_t deadline_us) {
+	int64_t stage_start;
+
+	if (!ui_isDirty()) {
+		return;
+	}
+
+	stage_start = profiler_start();
+	spiBus_acquire(SPI_BUS_CLIENT_DISPLAY, deadline_us);
+	ui_draw();
+	display_waitIdle();
+	spiBus_release(SPI_BUS_CLIENT_DISPLAY);
+	profiler_record(PROFILER_STAGE_FLUSH, stage_start);
+}
+
+/* Draws the whole level. Afterwards drawChangedCells() only touches the cells that change. */
+static void drawLevel(const game_snapshot_t * snapshot) {
+	const level_t * level = level_get(snapshot->level);
+
+	if (priv_background_level != snapshot->level) {
+		buildBackgroundCache(snapshot->level);
+	}
+
+	for (grid_cell_t cell = 0; cell < GRID_CELLS; cell++) {
+		drawBackgroundCell(level, cell);
+
+		if (snapshot->cells[cell] != SNAPSHOT_CELL_EMPTY) {
+			drawSpriteInFrameBuf(GRID_CELL_COLUMN(cell) * GRID_WIDTH, GRID_CELL_ROW(cell) * GRID_HEIGHT, snapshot->cells[cell]);
+		}
+	}
+
+	display_markAllDirty();
+}
+
+/* Redraws the cells whose contents differ from what is on the screen: the cell the tail left, the
+ * old head that became body, the new head and a new food. */
+static void drawChangedCells(const game_snapshot_t * snapshot) {
+	const level_t * level = level_get(snapshot->level);
+
+	for (grid_cell_t cell = 0; cell < GRID_CELLS; cell++) {
+		int x = GRID_CELL_COLUMN(cell) * GRID_WIDTH;
+		int y = GRID_CELL_ROW(cell) * GRID_HEIGHT;
+
+		if (snapshot->cells[cell] == priv_drawn.cells[cell]) {
+			continue;
+		}
+
+		drawBackgroundCell(level, cell);
+
+		if (snapshot->cells[cell] != SNAPSHOT_CELL_EMPTY) {
+			drawSpriteInFrameBuf(x, y, snapshot->cells[cell]);
+		}
+	}
+}
+
+/* Restores the background of one grid cell from the background cache. */
+static void drawBackgroundCell(const level_t * level, grid_cell_t cell) {
+	int x = GRID_CELL_COLUMN(cell) * GRID_WIDTH;
+	int y = GRID_CELL_ROW(cell) * GRID_HEIGHT;
+
+	if (priv_background_map[cell] == BACKGROUND_NOT_CACHED) {
+		const level_tile_t * tile = level_getTile(level, cell);
+
+		drawRectangleInFrameBuf(x, y, GRID_WIDTH, GRID_HEIGHT, tile->color);
+		if (tile->has_image) {
+			drawSpritePartInFrameBuf(tile->image_x, tile->image_y, tile->image, x, y, GRID_WIDTH, GRID_HEIGHT);
+		}
+	}
+	else {
+		const uint16_t * tile_pixels = &priv_background_tiles[priv_background_map[cell] * BACKGROUND_TILE_PIXELS];
+
+#ifdef CONFIG_ENGINAATOR_STRIP_RENDERER
+		displayList_addBitmap(x, y, GRID_WIDTH, GRID_HEIGHT, tile_pixels, x, y, GRID_WIDTH, GRID_HEIGHT);
+#else
+		blit_rect_t clip = { x, y, GRID_WIDTH, GRID_HEIGHT };
+
+		blit_copy(&priv_frame_surface, x, y, GRID_WIDTH, GRID_HEIGHT, tile_pixels, &clip);
+#endif
+	}
+
+	display_markDirty(x, y, GRID_WIDTH, GRID_HEIGHT);
+}
+
+
+/* Draws the level's background of one grid cell into a surface that covers it: the tile's colour
+ * and the part of its image, if it has one, that overlaps the cell. */
+static void drawBackgroundTile(const blit_surface_t * surface, const level_t * level, grid_cell_t cell) {
+	const level_tile_t * tile = level_getTile(level, cell);
+	blit_rect_t clip = { surface->x, surface->y, GRID_WIDTH, GRID_HEIGHT };
+
+	blit_fill(surface, surface->x, surface->y, GRID_WIDTH, GRID_HEIGHT, tile->color);
+	if (tile->has_image) {
+		assets_draw(surface, tile->image_x, tile->image_y, tile->image, &clip);
+	}
+}
+
+
+/* Rasterizes the background of a level into the cache. Plain cells of the same level tile share a
+ * cache tile. */
+static void buildBackgroundCache(uint8_t level_number) {
+	const level_t * level = level_get(level_number);
+	uint8_t plain_tiles[LEVEL_MAX_TILES];
+	uint8_t used = 0u;
+	bool full = false;
+
+	memset(plain_tiles, BACKGROUND_NOT_CACHED, sizeof(plain_tiles));
+
+	for (grid_cell_t cell = 0; cell < GRID_CELLS; cell++) {
+		uint8_t level_tile = level->tiles[cell];
+		bool plain = !level_getTile(level, cell)->has_image;
+		blit_surface_t surface;
+
+		if (plain && (plain_tiles[level_tile] != BACKGROUND_NOT_CACHED)) {
+			priv_background_map[cell] = plain_tiles[level_tile];
+			continue;
+		}
+
+		if (used == BACKGROUND_CACHE_TILES) {
+			priv_background_map[cell] = BACKGROUND_NOT_CACHED;
+			full = true;
+			continue;
+		}
+
+		surface = (blit_surface_t){ .pixels = &priv_background_tiles[used * BACKGROUND_TILE_PIXELS],
+									.x = (int16_t)(GRID_CELL_COLUMN(cell) * GRID_WIDTH), .y = (int16_t)(GRID_CELL_ROW(cell) * GRID_HEIGHT),
+									.width = GRID_WIDTH, .height = GRID_HEIGHT, .stride = GRID_WIDTH };
+		drawBackgroundTile(&surface, level, cell);
+
+		if (plain) {
+			plain_tiles[level_tile] = used;
+		}
+		priv_background_map[cell] = used;
+		used++;
+	}
+
+	if (full) {
+		printf("Background of level %u does not fit in %u tiles, the rest is drawn every time\n",
+			   (unsigned)level_number, BACKGROUND_CACHE_TILES);
+	}
+	priv_background_level = level_number;
+}
@@ -0,0 +1,16 @@
+/*
+ * render.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_RENDER_H_
+#define MAIN_RENDER_H_
+
+#include <stdint.h>
+#include "gameSnapshot.h"
+
+extern void render_init(void);
+extern void render_drawSnapshot(const game_snapshot_t * snapshot, int64_t deadline_us);
+
+#endif /* MAIN_RENDER_H_ */
@@ -0,0 +1,349 @@
+/*
+ * replay.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/param.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#include "sdCard.h"
+#include "profiler.h"
+#include "replay.h"
+
+/*
+ * The file is a replay_header_t followed by one record for every logic tick in which the game took
+ * an event or ran a snake step:
+ *
+ *   byte 0     ticks since the previous record (since replay_init() for the first one)
+ *   byte 1     snake steps in the high nibble, number of events in the low nibble
+ *   byte 2...  one input_event_type_t per event, in the order the game took them
+ *
+ * A gap longer than REPLAY_MAX_TICK_GAP is bridged with records that hold nothing. A game step
+ * record is two bytes, so a long game fits in a few KB.
+ */
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+#define REPLAY_MAGIC            0x50524e45u     /* "ENRP" */
+#define REPLAY_VERSION          1u
+
+#define REPLAY_MAX_TICK_GAP     0xFFu
+#define REPLAY_MAX_EVENTS       0x0Fu           /* Per tick, the rest wait for the next one */
+#define REPLAY_MAX_STEPS        0x0Fu
+#define REPLAY_RECORD_MAX_SIZE  (2u + REPLAY_MAX_EVENTS)
+
+/* Records are collected in RAM and written out when this fills up and when a game ends. */
+#define REPLAY_RECORD_BUFFER_SIZE   2048u
+/* Longest recording that can be replayed */
+#define REPLAY_MAX_FILE_SIZE        (32u * 1024u)
+
+/*
+**====================================================================================
+** Private type definitions
+**====================================================================================
+*/
+
+#pragma pack(push)
+#pragma pack(1)
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t seed;
+} replay_header_t;
+#pragma pack(pop)
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+#if defined(CONFIG_ENGINAATOR_INPUT_RECORD)
+static void append_record(uint8_t gap, uint8_t steps, const uint8_t * events, uint8_t event_count);
+#elif defined(CONFIG_ENGINAATOR_INPUT_REPLAY)
+static bool load_replay(uint32_t * seed);
+static void next_record(void);
+#endif
+
+/*
+**====================================================================================
+** Private variable declarations
+**====================================================================================
+*/
+
+/* Logic ticks since replay_init() */
+static uint32_t priv_tick;
+
+#if defined(CONFIG_ENGINAATOR_INPUT_RECORD)
+static uint8_t priv_buffer[REPLAY_RECORD_BUFFER_SIZE];
+static uint32_t priv_buffer_used;
+static uint32_t priv_record_tick;               /* Tick of the last record written */
+static uint8_t priv_tick_events[REPLAY_MAX_EVENTS];
+static uint8_t priv_tick_event_count;
+static uint8_t priv_tick_steps;
+#elif defined(CONFIG_ENGINAATOR_INPUT_REPLAY)
+static uint8_t priv_file[REPLAY_MAX_FILE_SIZE];
+static uint32_t priv_file_length;
+static uint32_t priv_file_pos;
+static bool priv_replaying;
+static uint32_t priv_record_tick;               /* Tick the current record is for */
+static uint8_t priv_record_steps;
+static uint8_t priv_record_event_count;
+static const uint8_t * priv_record_events;
+static uint8_t priv_events_taken;
+#endif
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+/* Starts recording or replaying, from the app_main task before the logic task runs. Returns the
+ * seed for the game's random numbers: live_seed, unless it comes from the recording. */
+uint32_t replay_init(uint32_t live_seed)
+{
+    priv_tick = 0u;
+
+#if defined(CONFIG_ENGINAATOR_INPUT_RECORD)
+    replay_header_t header = { .magic = REPLAY_MAGIC, .version = REPLAY_VERSION, .reserved = 0u, .seed = live_seed };
+
+    if (sdCard_Write_file(REPLAY_RECORD_PATH, &header, sizeof(header), false) == ESP_OK)
+    {
+        printf("Recording input to %s\n", REPLAY_RECORD_PATH);
+    }
+    return live_seed;
+#elif defined(CONFIG_ENGINAATOR_INPUT_REPLAY)
+    uint32_t seed;
+
+    if (!load_replay(&seed))
+    {
+        printf("No replay in %s, playing live\n", REPLAY_REPLAY_PATH);
+        return live_seed;
+    }
+
+    printf("Replaying %s, %u bytes\n", REPLAY_REPLAY_PATH, (unsigned)priv_file_length);
+    priv_replaying = true;
+    priv_record_tick = 0u;
+    next_record();
+    return seed;
+#else
+    return live_seed;
+#endif
+}
+
+
+/* Use in place of input_getEvent(). */
+bool replay_getEvent(input_event_t * event)
+{
+#if defined(CONFIG_ENGINAATOR_INPUT_RECORD)
+    if ((priv_tick_event_count == REPLAY_MAX_EVENTS) || !input_getEvent(event))
+    {
+        return false;
+    }
+
+    priv_tick_events[priv_tick_event_count++] = (uint8_t)event->type;
+    return true;
+#elif defined(CONFIG_ENGINAATOR_INPUT_REPLAY)
+    if (!priv_replaying)
+    {
+        return input_getEvent(event);
+    }
+
+    if ((priv_record_tick != priv_tick) || (priv_events_taken == priv_record_event_count))
+    {
+        return false;
+    }
+
+    event->type = (input_event_type_t)priv_record_events[priv_events_taken++];
+    event->timestamp_us = esp_timer_get_time();
+    return true;
+#else
+    return input_getEvent(event);
+#endif
+}
+
+
+/* Takes the number of snake steps the scheduler wants to run this tick and returns the number
+ * to run. */
+uint32_t replay_getSteps(uint32_t live_steps)
+{
+#if defined(CONFIG_ENGINAATOR_INPUT_RECORD)
+    priv_tick_steps = (uint8_t)MIN(live_steps, REPLAY_MAX_STEPS);
+    return priv_tick_steps;
+#elif defined(CONFIG_ENGINAATOR_INPUT_REPLAY)
+    if (!priv_replaying)
+    {
+        return live_steps;
+    }
+
+    return (priv_record_tick == priv_tick) ? priv_record_steps : 0u;
+#else
+    return live_steps;
+#endif
+}
+
+
+/* Call once at the end of every logic tick. */
+void replay_endTick(void)
+{
+#if defined(CONFIG_ENGINAATOR_INPUT_RECORD)
+    if ((priv_tick_steps != 0u) || (priv_tick_event_count != 0u))
+    {
+        while ((priv_tick - priv_record_tick) > REPLAY_MAX_TICK_GAP)
+        {
+            append_record(REPLAY_MAX_TICK_GAP, 0u, NULL, 0u);
+            priv_record_tick += REPLAY_MAX_TICK_GAP;
+        }
+
+        append_record((uint8_t)(priv_tick - priv_record_tick), priv_tick_steps, priv_tick_events, priv_tick_event_count);
+        priv_record_tick = priv_tick;
+        priv_tick_steps = 0u;
+        priv_tick_event_count = 0u;
+    }
+#elif defined(CONFIG_ENGINAATOR_INPUT_REPLAY)
+    if (priv_replaying)
+    {
+        input_event_t ignored;
+
+        /* The joystick is not listened to, but its events must not pile up for when the replay ends. */
+        while (input_getEvent(&ignored))
+        {
+        }
+
+        if (priv_record_tick == priv_tick)
+        {
+            next_record();
+        }
+
+        if (!priv_replaying)
+        {
+            printf("Replay finished after %u ticks, playing live\n", (unsigned)priv_tick);
+            profiler_report();
+        }
+    }
+#endif
+
+    priv_tick++;
+}
+
+
+/* Writes what has been recorded so far to the card. Call when a game ends, so the recording is
+ * complete even if the board is switched off. */
+void replay_flush(void)
+{
+#if defined(CONFIG_ENGINAATOR_INPUT_RECORD)
+    if (priv_buffer_used > 0u)
+    {
+        (void)sdCard_Write_file(REPLAY_RECORD_PATH, priv_buffer, priv_buffer_used, true);
+        priv_buffer_used = 0u;
+    }
+#endif
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+#if defined(CONFIG_ENGINAATOR_INPUT_RECORD)
+
+static void append_record(uint8_t gap, uint8_t steps, const uint8_t * events, uint8_t event_count)
+{
+    if ((priv_buffer_used + REPLAY_RECORD_MAX_SIZE) > REPLAY_RECORD_BUFFER_SIZE)
+    {
+        replay_flush();
+    }
+
+    priv_buffer[priv_buffer_used++] = gap;
+    priv_buffer[priv_buffer_used++] = (uint8_t)((steps << 4) | event_count);
+    if (event_count > 0u)
+    {
+        memcpy(&priv_buffer[priv_buffer_used], events, event_count);
+        priv_buffer_used += event_count;
+    }
+}
+
+#elif defined(CONFIG_ENGINAATOR_INPUT_REPLAY)
+
+/* Reads the whole recording into RAM, so replaying it never touches the SD card. */
+static bool load_replay(uint32_t * seed)
+{
+    static sdCard_prefetch_t request;
+    replay_header_t header;
+
+    if (sdCard_Prefetch_file(&request, REPLAY_REPLAY_PATH, priv_file, sizeof(priv_file)) != ESP_OK)
+    {
+        return false;
+    }
+
+    while (!sdCard_Prefetch_done(&request))
+    {
+        vTaskDelay(1);
+    }
+
+    if ((request.result != ESP_OK) || (request.length < sizeof(header)))
+    {
+        return false;
+    }
+
+    memcpy(&header, priv_file, sizeof(header));
+    if ((header.magic != REPLAY_MAGIC) || (header.version != REPLAY_VERSION))
+    {
+        printf("%s is not a replay\n", REPLAY_REPLAY_PATH);
+        return false;
+    }
+
+    *seed = header.seed;
+    priv_file_length = request.length;
+    priv_file_pos = sizeof(header);
+    return true;
+}
+
+
+/* Moves on to the next record, or ends the replay after the last one. */
+static void next_record(void)
+{
+    uint8_t packed;
+
+    if ((priv_file_pos + 2u) > priv_file_length)
+    {
+        priv_replaying = false;
+        return;
+    }
+
+    priv_record_tick += priv_file[priv_file_pos];
+    packed = priv_file[priv_file_pos + 1u];
+    priv_record_steps = packed >> 4;
+    priv_record_event_count = packed & REPLAY_MAX_EVENTS;
+    priv_record_events = &priv_file[priv_file_pos + 2u];
+    priv_events_taken = 0u;
+    priv_file_pos += 2u + priv_record_event_count;
+
+    if (priv_file_pos > priv_file_length)
+    {
+        printf("%s is cut short\n", REPLAY_REPLAY_PATH);
+        priv_replaying = false;
+    }
+}
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * replay.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_REPLAY_H_
+#define MAIN_REPLAY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "input.h"
+
+/* Sits between the game and its inputs: the joystick events and the number of snake steps each
+ * logic tick runs. With CONFIG_ENGINAATOR_INPUT_RECORD they are written to REPLAY_RECORD_PATH on
+ * the SD card together with the random seed. With CONFIG_ENGINAATOR_INPUT_REPLAY they come from
+ * REPLAY_REPLAY_PATH instead of the joystick and the clock, so the game plays out exactly as it
+ * did when it was recorded, on the board or in the simulator. Otherwise they are passed through. */
+#define REPLAY_RECORD_PATH  "/record.bin"
+#define REPLAY_REPLAY_PATH  "/replay.bin"
+
+extern uint32_t replay_init(uint32_t live_seed);
+extern bool replay_getEvent(input_event_t * event);
+extern uint32_t replay_getSteps(uint32_t live_steps);
+extern void replay_endTick(void);
+extern void replay_flush(void);
+
+#endif /* MAIN_REPLAY_H_ */
@@ -0,0 +1,65 @@
+/*
+ * scheduler.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <string.h>
+#include <assert.h>
+
+#include "scheduler.h"
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+/* The first tick is due one period after now. Clears the statistics. */
+void scheduler_start(scheduler_t * scheduler, int64_t tick_period_us, int64_t now_us)
+{
+    assert(tick_period_us > 0);
+
+    memset(scheduler, 0, sizeof(*scheduler));
+    scheduler->tick_period_us = tick_period_us;
+    scheduler->last_update_us = now_us;
+}
+
+
+/* Returns how many ticks the caller should run now. Call once per frame. */
+uint32_t scheduler_update(scheduler_t * scheduler, int64_t now_us)
+{
+    uint32_t due;
+
+    scheduler->accumulator_us += now_us - scheduler->last_update_us;
+    scheduler->last_update_us = now_us;
+
+    due = (uint32_t)(scheduler->accumulator_us / scheduler->tick_period_us);
+    scheduler->accumulator_us -= (int64_t)due * scheduler->tick_period_us;
+
+    if (due > SCHEDULER_MAX_CATCH_UP_TICKS)
+    {
+        scheduler->stats.missed_ticks += due - SCHEDULER_MAX_CATCH_UP_TICKS;
+        due = SCHEDULER_MAX_CATCH_UP_TICKS;
+    }
+
+    if (due > 1u)
+    {
+        scheduler->stats.late_frames++;
+    }
+
+    scheduler->stats.ticks += due;
+
+    return due;
+}
+
+
+const scheduler_stats_t * scheduler_getStats(const scheduler_t * scheduler)
+{
+    return &scheduler->stats;
+}
@@ -0,0 +1,37 @@
+/*
+ * scheduler.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_SCHEDULER_H_
+#define MAIN_SCHEDULER_H_
+
+#include <stdint.h>
+
+/* Most ticks one update will run to catch up. If the loop falls further behind than this, for
+ * example while stopped in a debugger, the rest are dropped and counted as missed. */
+#define SCHEDULER_MAX_CATCH_UP_TICKS 5u
+
+typedef struct
+{
+    uint32_t ticks;             /* Ticks run */
+    uint32_t missed_ticks;      /* Ticks dropped, see SCHEDULER_MAX_CATCH_UP_TICKS */
+    uint32_t late_frames;       /* Updates that had to run more than one tick */
+} scheduler_stats_t;
+
+/* Fixed timestep: time passed in from the caller is accumulated and paid out in whole ticks, so the
+ * tick rate stays exact however long the frames in between take. */
+typedef struct
+{
+    int64_t tick_period_us;
+    int64_t last_update_us;
+    int64_t accumulator_us;
+    scheduler_stats_t stats;
+} scheduler_t;
+
+extern void scheduler_start(scheduler_t * scheduler, int64_t tick_period_us, int64_t now_us);
+extern uint32_t scheduler_update(scheduler_t * scheduler, int64_t now_us);
+extern const scheduler_stats_t * scheduler_getStats(const scheduler_t * scheduler);
+
+#endif /* MAIN_SCHEDULER_H_ */
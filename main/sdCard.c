@@ -6,17 +6,43 @@
  */
 #include <stdio.h>
 #include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 #include "esp_timer.h"
 #include "esp_task_wdt.h"
 #include "esp_vfs_fat.h"
 
 #include "sdCard.h"
 #include "display.h"
+#include "assetFormat.h"
+#include "spiBus.h"
+#include "profiler.h"
 
 #define MOUNT_POINT "/sdcard"
 #define PIN_NUM_SDCARD_CS    16
 
+#define SD_SECTOR_SIZE       512u
+/* Pixel data is read in chunks of whole sectors, so FATFS can read them straight into the buffer. */
+#define BMP_READ_CHUNK_SIZE  (8u * SD_SECTOR_SIZE)
+
+#define BMP_MAGIC            0x4d42u
+#define BMP_BITS_PER_PIXEL   24u
+#define BMP_COMPRESSION_NONE 0u
+/* Indexed BMPs have a colour table of 4 byte BGRX entries after the DIB header. */
+#define BMP_FILE_HEADER_SIZE 14u
+#define BMP_MAX_COLORS       256u
+
+/* A prefetch gives the bus back after every chunk. About 2 ms at the 4 MHz SD clock, which is the
+ * longest a frame flush has to wait for it. */
+#define PREFETCH_CHUNK_SIZE      (2u * SD_SECTOR_SIZE)
+#define PREFETCH_QUEUE_LENGTH    4u
+#define PREFETCH_TASK_PRIORITY   (tskIDLE_PRIORITY + 1u)
+#define PREFETCH_TASK_STACK_SIZE 3072u
+
 
 /****************** Private type definitions *******************/
 
@@ -45,12 +71,35 @@ typedef struct
 
 
 /**************** Private function forward declarations **************/
-static esp_err_t read_bmp_file(const char *path, uint16_t * output_buffer);
+static esp_err_t read_bmp_file(const char *path, uint16_t * output_buffer, uint16_t width, uint16_t height);
+static esp_err_t check_bmp_header(const char *path, const BMPHeader * header, uint16_t width, uint16_t height);
+static esp_err_t read_bmp_color_table(FILE *f, const BMPHeader * header);
+static esp_err_t stream_bmp_pixels(FILE *f, const BMPHeader * header, uint16_t * output_buffer);
+static void convert_bmp_line(const uint8_t * src, uint16_t * dest, uint16_t width, uint16_t bits_per_pixel);
+static esp_err_t read_rgb565_file(const char *path, uint16_t * output_buffer, uint16_t width, uint16_t height);
+static void log_throughput(const char *path, uint32_t file_bytes, int64_t start);
+static const asset_pack_entry_t * find_pack_entry(const char *name);
+static esp_err_t open_asset_pack(const char *path);
+static esp_err_t read_asset_pack_entry(const char *name, uint16_t * output_buffer, uint16_t width, uint16_t height);
+static void close_asset_pack(void);
+static void prefetch_task(void * param);
+static esp_err_t prefetch_file(sdCard_prefetch_t * request);
 static const char *TAG = "SD Card Handler";
 
 /**************** Private variable declarations ******************/
 
+/* Holds a line that is split between two chunks. */
 uint8_t  bmp_line_buffer[(MAX_BMP_LINE_LENGTH * 3) + 4u];
+static uint8_t bmp_read_buffer[BMP_READ_CHUNK_SIZE];
+/* Colour table of the indexed BMP being read, as RGB565 */
+static uint16_t bmp_color_table[BMP_MAX_COLORS];
+
+/* The open asset pack and its table of contents */
+static FILE * priv_pack_file = NULL;
+static asset_pack_entry_t priv_pack_toc[ASSET_PACK_MAX_ENTRIES];
+static uint16_t priv_pack_entry_count = 0u;
+
+static QueueHandle_t priv_prefetch_queue;
 
 /**************** Public functions  **************/
 void sdCard_init(void)
@@ -75,7 +124,7 @@ void sdCard_init(void)
     // Example: for fixed frequency of 10MHz, use host.max_freq_khz = 10000;
     sdmmc_host_t host = SDSPI_HOST_DEFAULT();
 
-    host.slot = SPI2_HOST;
+    host.slot = SPI_BUS_HOST;
     host.max_freq_khz = 4000;
 
     // This initializes the slot without card detect (CD) and write protect (WP) signals.
@@ -85,7 +134,9 @@ void sdCard_init(void)
     slot_config.host_id = host.slot;
 
     ESP_LOGI(TAG, "Mounting filesystem");
+    spiBus_acquire(SPI_BUS_CLIENT_SDCARD, SPI_BUS_NO_DEADLINE);
     ret = esp_vfs_fat_sdspi_mount(mount_point, &host, &slot_config, &mount_config, &card);
+    spiBus_release(SPI_BUS_CLIENT_SDCARD);
 
     if (ret != ESP_OK)
     {
@@ -103,16 +154,157 @@ void sdCard_init(void)
     }
 
     ESP_LOGI(TAG, "Filesystem mounted");
+
+    priv_prefetch_queue = xQueueCreate(PREFETCH_QUEUE_LENGTH, sizeof(sdCard_prefetch_t *));
+    assert(priv_prefetch_queue);
+    xTaskCreatePinnedToCore(prefetch_task, "prefetch", PREFETCH_TASK_STACK_SIZE, NULL, PREFETCH_TASK_PRIORITY, NULL, 0);
+}
+
+
+/* Loads a 24 bit, or 4 or 8 bit indexed, BMP of exactly width x height pixels into output_buffer as
+ * RGB565, top line first. */
+esp_err_t sdCard_Read_bmp_file(const char *path, uint16_t * output_buffer, uint16_t width, uint16_t height)
+{
+	char str[64] = MOUNT_POINT;
+	esp_err_t ret;
+	int64_t start;
+	strcat(str, path);
+
+	start = profiler_start();
+	spiBus_acquire(SPI_BUS_CLIENT_SDCARD, SPI_BUS_NO_DEADLINE);
+	ret = read_bmp_file(str, output_buffer, width, height);
+	spiBus_release(SPI_BUS_CLIENT_SDCARD);
+	profiler_record(PROFILER_STAGE_SD, start);
+
+	return ret;
+}
+
+
+/* Loads a precompiled image (see assetFormat.h) of exactly width x height pixels. The pixels are
+ * read straight into output_buffer. Returns ESP_ERR_NOT_FOUND if there is no such file. */
+esp_err_t sdCard_Read_rgb565_file(const char *path, uint16_t * output_buffer, uint16_t width, uint16_t height)
+{
+	char str[64] = MOUNT_POINT;
+	esp_err_t ret;
+	int64_t start;
+	strcat(str, path);
+
+	start = profiler_start();
+	spiBus_acquire(SPI_BUS_CLIENT_SDCARD, SPI_BUS_NO_DEADLINE);
+	ret = read_rgb565_file(str, output_buffer, width, height);
+	spiBus_release(SPI_BUS_CLIENT_SDCARD);
+	profiler_record(PROFILER_STAGE_SD, start);
+
+	return ret;
+}
+/* Opens an asset pack (see assetFormat.h) and reads its table of contents. The file stays open
+ * until sdCard_Close_asset_pack(), so every entry costs one seek and one read. */
+esp_err_t sdCard_Open_asset_pack(const char *path)
+{
+	esp_err_t ret;
+	int64_t start;
+
+	start = profiler_start();
+	spiBus_acquire(SPI_BUS_CLIENT_SDCARD, SPI_BUS_NO_DEADLINE);
+	ret = open_asset_pack(path);
+	spiBus_release(SPI_BUS_CLIENT_SDCARD);
+	profiler_record(PROFILER_STAGE_SD, start);
+
+	return ret;
 }
 
 
-void sdCard_Read_bmp_file(const char *path, uint16_t * output_buffer)
+/* Reads the RGB565 entry called name from the open pack. It must be exactly width x height pixels.
+ * Returns ESP_ERR_NOT_FOUND if no pack is open or it has no such entry. */
+esp_err_t sdCard_Read_asset_pack_entry(const char *name, uint16_t * output_buffer, uint16_t width, uint16_t height)
+{
+	esp_err_t ret;
+	int64_t start;
+
+	start = profiler_start();
+	spiBus_acquire(SPI_BUS_CLIENT_SDCARD, SPI_BUS_NO_DEADLINE);
+	ret = read_asset_pack_entry(name, output_buffer, width, height);
+	spiBus_release(SPI_BUS_CLIENT_SDCARD);
+	profiler_record(PROFILER_STAGE_SD, start);
+
+	return ret;
+}
+
+
+void sdCard_Close_asset_pack(void)
+{
+	spiBus_acquire(SPI_BUS_CLIENT_SDCARD, SPI_BUS_NO_DEADLINE);
+	close_asset_pack();
+	spiBus_release(SPI_BUS_CLIENT_SDCARD);
+}
+
+
+/* Writes length bytes to the file, after what is already in it if append is set. Returns once
+ * the file is closed again. */
+esp_err_t sdCard_Write_file(const char *path, const void * data, uint32_t length, bool append)
 {
 	char str[64] = MOUNT_POINT;
+	esp_err_t ret = ESP_OK;
+	int64_t start;
+	FILE *f;
 	strcat(str, path);
 
-	read_bmp_file(str, output_buffer);
+	start = profiler_start();
+	spiBus_acquire(SPI_BUS_CLIENT_SDCARD, SPI_BUS_NO_DEADLINE);
+	f = fopen(str, append ? "ab" : "wb");
+	if (f == NULL)
+	{
+		ESP_LOGE(TAG, "Failed to open file for writing");
+		ret = ESP_ERR_NOT_FOUND;
+	}
+	else
+	{
+		if (fwrite(data, sizeof(uint8_t), length, f) != length)
+		{
+			ret = ESP_FAIL;
+		}
+		fclose(f);
+	}
+	spiBus_release(SPI_BUS_CLIENT_SDCARD);
+	profiler_record(PROFILER_STAGE_SD, start);
+
+	return ret;
 }
+
+
+/* Reads up to size bytes of the file into buffer in the background, only while nobody else needs
+ * the bus. request must stay valid, and buffer untouched, until sdCard_Prefetch_done() returns true;
+ * then request->result and request->length tell how it went. The result is ESP_OK once the whole
+ * file, or size bytes of it, has been read, and ESP_FAIL if the card failed partway; length then
+ * counts only the bytes read before that. */
+esp_err_t sdCard_Prefetch_file(sdCard_prefetch_t * request, const char *path, void * buffer, uint32_t size)
+{
+	if ((priv_prefetch_queue == NULL) || (strlen(path) >= sizeof(request->path)))
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	strcpy(request->path, path);
+	request->buffer = buffer;
+	request->size = size;
+	request->length = 0u;
+	request->result = ESP_OK;
+	atomic_store(&request->done, false);
+
+	if (xQueueSend(priv_prefetch_queue, &request, 0) != pdPASS)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	return ESP_OK;
+}
+
+
+bool sdCard_Prefetch_done(const sdCard_prefetch_t * request)
+{
+	return atomic_load(&request->done);
+}
+
 /* void sdCard_Read_text_file(const char *path, char * output_buffer)
 {
     char str[64] = MOUNT_POINT;
@@ -142,13 +334,12 @@ void sdCard_Read_bmp_file(const char *path, uint16_t * output_buffer)
     return ESP_OK;
 } */
 
-static esp_err_t read_bmp_file(const char *path, uint16_t * output_buffer)
+static esp_err_t read_bmp_file(const char *path, uint16_t * output_buffer, uint16_t width, uint16_t height)
 {
 	BMPHeader header;
 	FILE *f;
-	uint16_t line_stride;
-	uint16_t line_px_data_len;
-	uint16_t * dest_ptr = output_buffer;
+	esp_err_t ret;
+	int64_t start = esp_timer_get_time();
 
 	ESP_LOGI(TAG, "Reading file %s", path);
     f = fopen(path, "r");
@@ -159,27 +350,428 @@ static esp_err_t read_bmp_file(const char *path, uint16_t * output_buffer)
         return ESP_FAIL;
     }
 
-    fread(&header, sizeof(BMPHeader), 1u, f);
+    if (fread(&header, sizeof(BMPHeader), 1u, f) != 1u)
+    {
+        ESP_LOGE(TAG, "%s: file is shorter than a BMP header", path);
+        fclose(f);
+        return ESP_FAIL;
+    }
 
-    ESP_LOGE(TAG, "Bitmap width : %ld", header.width_px);
-    ESP_LOGE(TAG, "Bitmap height : %ld", header.height_px);
+    ret = check_bmp_header(path, &header, width, height);
 
-    /* Take padding into account... */
-    line_px_data_len = header.width_px * 3u;
-    line_stride = (line_px_data_len + 3u) & ~0x03;
+    if ((ret == ESP_OK) && (header.bits_per_pixel != BMP_BITS_PER_PIXEL))
+    {
+        ret = read_bmp_color_table(f, &header);
+
+        if (ret != ESP_OK)
+        {
+            ESP_LOGE(TAG, "%s: colour table is truncated", path);
+        }
+    }
 
-    for (int y = 0u; y < header.height_px; y++)
+    if (ret == ESP_OK)
     {
-    	fseek(f, ((header.height_px - (y + 1)) * line_stride) + header.offset, SEEK_SET);
-    	fread(bmp_line_buffer, sizeof(uint8_t), line_stride, f);
+        ret = stream_bmp_pixels(f, &header, output_buffer);
 
-      for (int x = 0u; x < line_px_data_len; x+=3u )
-      {
-        *dest_ptr++ = CONVERT_888RGB_TO_565RGB(bmp_line_buffer[x + 2], bmp_line_buffer[x+1], bmp_line_buffer[x]);
-      }
+        if (ret != ESP_OK)
+        {
+            ESP_LOGE(TAG, "%s: pixel data is truncated", path);
+        }
     }
 
     fclose(f);
 
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    log_throughput(path, header.offset + (((((width * header.bits_per_pixel) + 31u) / 32u) * 4u) * height), start);
+
+    return ESP_OK;
+}
+
+
+static esp_err_t check_bmp_header(const char *path, const BMPHeader * header, uint16_t width, uint16_t height)
+{
+    if (header->type != BMP_MAGIC)
+    {
+        ESP_LOGE(TAG, "%s: not a BMP file", path);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (((header->bits_per_pixel != BMP_BITS_PER_PIXEL) && (header->bits_per_pixel != 8u) && (header->bits_per_pixel != 4u)) ||
+        (header->compression != BMP_COMPRESSION_NONE))
+    {
+        ESP_LOGE(TAG, "%s: %u bpp with compression %" PRIu32 ", only uncompressed 4, 8 and 24 bpp are supported",
+                 path, header->bits_per_pixel, header->compression);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if ((header->width_px <= 0) || (header->width_px > (int32_t)MAX_BMP_LINE_LENGTH) || (header->offset < sizeof(BMPHeader)))
+    {
+        ESP_LOGE(TAG, "%s: bad header, width %" PRId32 ", pixel offset %" PRIu32, path, header->width_px, header->offset);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    /* A negative height means the lines are stored top-down. */
+    if ((header->width_px != width) || ((header->height_px != height) && (header->height_px != -(int32_t)height)))
+    {
+        ESP_LOGE(TAG, "%s: image is %" PRId32 " x %" PRId32 ", expected %u x %u",
+                 path, header->width_px, header->height_px, width, height);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    return ESP_OK;
+}
+
+
+/* Converts the colour table of an indexed BMP to RGB565. Colours it does not list are black. */
+static esp_err_t read_bmp_color_table(FILE *f, const BMPHeader * header)
+{
+    uint32_t colors = (1u << header->bits_per_pixel);
+
+    if ((header->num_colors != 0u) && (header->num_colors < colors))
+    {
+        colors = header->num_colors;
+    }
+
+    memset(bmp_color_table, 0, sizeof(bmp_color_table));
+
+    if ((fseek(f, BMP_FILE_HEADER_SIZE + header->dib_header_size, SEEK_SET) != 0) ||
+        (fread(bmp_read_buffer, 4u, colors, f) != colors))
+    {
+        return ESP_FAIL;
+    }
+
+    for (uint32_t ix = 0u; ix < colors; ix++)
+    {
+        const uint8_t * bgrx = &bmp_read_buffer[ix * 4u];
+        bmp_color_table[ix] = CONVERT_888RGB_TO_565RGB(bgrx[2], bgrx[1], bgrx[0]);
+    }
+
     return ESP_OK;
 }
+
+
+/* Reads the pixel array front to back without seeking, placing each line where it belongs. */
+static esp_err_t stream_bmp_pixels(FILE *f, const BMPHeader * header, uint16_t * output_buffer)
+{
+    uint16_t width = header->width_px;
+    uint32_t lines = (header->height_px < 0) ? -header->height_px : header->height_px;
+    bool bottom_up = (header->height_px > 0);
+    uint32_t line_px_data_len = ((width * header->bits_per_pixel) + 7u) / 8u;
+    uint32_t line_stride = (line_px_data_len + 3u) & ~0x03u;
+    uint32_t remaining = line_stride * lines;
+    uint32_t file_pos = header->offset;
+    uint32_t line = 0u;
+    uint32_t line_fill = 0u;
+
+    if (fseek(f, header->offset, SEEK_SET) != 0)
+    {
+        return ESP_FAIL;
+    }
+
+    while (remaining > 0u)
+    {
+        /* The first chunk only runs up to a sector boundary, the rest are sector aligned. */
+        uint32_t chunk = MIN(BMP_READ_CHUNK_SIZE - (file_pos % SD_SECTOR_SIZE), remaining);
+        const uint8_t * src = bmp_read_buffer;
+
+        if (fread(bmp_read_buffer, sizeof(uint8_t), chunk, f) != chunk)
+        {
+            return ESP_FAIL;
+        }
+
+        file_pos += chunk;
+        remaining -= chunk;
+
+        while (chunk > 0u)
+        {
+            const uint8_t * line_data = NULL;
+
+            if ((line_fill == 0u) && (chunk >= line_stride))
+            {
+                line_data = src;
+                src += line_stride;
+                chunk -= line_stride;
+            }
+            else
+            {
+                uint32_t part = MIN(line_stride - line_fill, chunk);
+
+                memcpy(&bmp_line_buffer[line_fill], src, part);
+                line_fill += part;
+                src += part;
+                chunk -= part;
+
+                if (line_fill == line_stride)
+                {
+                    line_data = bmp_line_buffer;
+                    line_fill = 0u;
+                }
+            }
+
+            if (line_data != NULL)
+            {
+                uint32_t dest_line = bottom_up ? (lines - 1u - line) : line;
+
+                convert_bmp_line(line_data, &output_buffer[dest_line * width], width, header->bits_per_pixel);
+                line++;
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+
+static void convert_bmp_line(const uint8_t * src, uint16_t * dest, uint16_t width, uint16_t bits_per_pixel)
+{
+    if (bits_per_pixel == 8u)
+    {
+        for (uint32_t x = 0u; x < width; x++)
+        {
+            dest[x] = bmp_color_table[src[x]];
+        }
+        return;
+    }
+
+    if (bits_per_pixel == 4u)
+    {
+        /* The left pixel is in the high nibble. */
+        for (uint32_t x = 0u; x < width; x++)
+        {
+            dest[x] = bmp_color_table[(src[x >> 1] >> (((~x) & 1u) << 2)) & 0x0Fu];
+        }
+        return;
+    }
+
+    for (uint32_t x = 0u; x < width; x++)
+    {
+        dest[x] = CONVERT_888RGB_TO_565RGB(src[2], src[1], src[0]);
+        src += 3;
+    }
+}
+
+
+static esp_err_t read_rgb565_file(const char *path, uint16_t * output_buffer, uint16_t width, uint16_t height)
+{
+    asset_rgb565_header_t header;
+    FILE *f;
+    uint32_t pixel_count = (uint32_t)width * height;
+    int64_t start = esp_timer_get_time();
+
+    f = fopen(path, "r");
+
+    if (f == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (fread(&header, sizeof(header), 1u, f) != 1u)
+    {
+        ESP_LOGE(TAG, "%s: file is shorter than its header", path);
+        fclose(f);
+        return ESP_FAIL;
+    }
+
+    if ((header.magic != ASSET_RGB565_MAGIC) || (header.version != ASSET_RGB565_VERSION))
+    {
+        ESP_LOGE(TAG, "%s: not an RGB565 image, or version %u", path, header.version);
+        fclose(f);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if ((header.width != width) || (header.height != height))
+    {
+        ESP_LOGE(TAG, "%s: image is %u x %u, expected %u x %u", path, header.width, header.height, width, height);
+        fclose(f);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (fread(output_buffer, sizeof(uint16_t), pixel_count, f) != pixel_count)
+    {
+        ESP_LOGE(TAG, "%s: pixel data is truncated", path);
+        fclose(f);
+        return ESP_FAIL;
+    }
+
+    fclose(f);
+
+    log_throughput(path, sizeof(header) + (pixel_count * sizeof(uint16_t)), start);
+
+    return ESP_OK;
+}
+
+
+static void log_throughput(const char *path, uint32_t file_bytes, int64_t start)
+{
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "%s: %" PRIu32 " bytes in %" PRId64 " us, %" PRId64 " KB/s", path, file_bytes, elapsed,
+             (elapsed > 0) ? ((int64_t)file_bytes * 1000000 / elapsed) / 1024 : 0);
+}
+
+
+/* The bodies of the public asset pack functions, called with the bus held. */
+static esp_err_t open_asset_pack(const char *path)
+{
+	char str[64] = MOUNT_POINT;
+	asset_pack_header_t header;
+	int64_t start = esp_timer_get_time();
+
+	strcat(str, path);
+	close_asset_pack();
+
+	priv_pack_file = fopen(str, "r");
+
+	if (priv_pack_file == NULL)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	if ((fread(&header, sizeof(header), 1u, priv_pack_file) != 1u) ||
+		(header.magic != ASSET_PACK_MAGIC) || (header.version != ASSET_PACK_VERSION) ||
+		(header.entry_count > ASSET_PACK_MAX_ENTRIES) ||
+		(fread(priv_pack_toc, sizeof(asset_pack_entry_t), header.entry_count, priv_pack_file) != header.entry_count))
+	{
+		ESP_LOGE(TAG, "%s: not a valid asset pack", str);
+		close_asset_pack();
+		return ESP_ERR_NOT_SUPPORTED;
+	}
+
+	priv_pack_entry_count = header.entry_count;
+	ESP_LOGI(TAG, "%s: %u entries, table of contents read in %" PRId64 " us",
+			 str, priv_pack_entry_count, esp_timer_get_time() - start);
+
+	return ESP_OK;
+}
+
+
+static esp_err_t read_asset_pack_entry(const char *name, uint16_t * output_buffer, uint16_t width, uint16_t height)
+{
+	const asset_pack_entry_t * entry = find_pack_entry(name);
+	int64_t start = esp_timer_get_time();
+
+	if (entry == NULL)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	if ((entry->format != ASSET_FORMAT_RGB565) || (entry->width != width) || (entry->height != height) ||
+		(entry->size != ((uint32_t)width * height * sizeof(uint16_t))))
+	{
+		ESP_LOGE(TAG, "%s: pack entry is format %u, %u x %u, expected RGB565 %u x %u",
+				 name, entry->format, entry->width, entry->height, width, height);
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	if ((fseek(priv_pack_file, entry->offset, SEEK_SET) != 0) ||
+		(fread(output_buffer, sizeof(uint8_t), entry->size, priv_pack_file) != entry->size))
+	{
+		ESP_LOGE(TAG, "%s: pack entry is truncated", name);
+		return ESP_FAIL;
+	}
+
+	log_throughput(name, entry->size, start);
+
+	return ESP_OK;
+}
+
+
+static void close_asset_pack(void)
+{
+	if (priv_pack_file != NULL)
+	{
+		fclose(priv_pack_file);
+		priv_pack_file = NULL;
+	}
+
+	priv_pack_entry_count = 0u;
+}
+
+
+/* Works through the prefetch requests one at a time. */
+static void prefetch_task(void * param)
+{
+    sdCard_prefetch_t * request;
+    int64_t start;
+
+    (void)param;
+
+    while (1)
+    {
+        xQueueReceive(priv_prefetch_queue, &request, portMAX_DELAY);
+        start = profiler_start();
+        request->result = prefetch_file(request);
+        profiler_record(PROFILER_STAGE_SD, start);
+        atomic_store(&request->done, true);
+    }
+}
+
+
+/* Takes the bus for one chunk at a time, at the lowest priority, so frame flushes and other reads
+ * go first. */
+static esp_err_t prefetch_file(sdCard_prefetch_t * request)
+{
+    char str[64] = MOUNT_POINT;
+    uint8_t * dest = request->buffer;
+    FILE *f;
+    uint32_t chunk;
+    size_t read;
+    bool failed;
+
+    strcat(str, request->path);
+
+    spiBus_acquire(SPI_BUS_CLIENT_PREFETCH, SPI_BUS_NO_DEADLINE);
+    f = fopen(str, "r");
+    spiBus_release(SPI_BUS_CLIENT_PREFETCH);
+
+    if (f == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    do
+    {
+        chunk = MIN(PREFETCH_CHUNK_SIZE, request->size - request->length);
+
+        spiBus_acquire(SPI_BUS_CLIENT_PREFETCH, SPI_BUS_NO_DEADLINE);
+        read = fread(&dest[request->length], sizeof(uint8_t), chunk, f);
+        spiBus_release(SPI_BUS_CLIENT_PREFETCH);
+
+        request->length += read;
+    } while ((read == chunk) && (request->length < request->size));
+
+    /* A short read is the end of the file, unless the card failed */
+    failed = (ferror(f) != 0);
+
+    spiBus_acquire(SPI_BUS_CLIENT_PREFETCH, SPI_BUS_NO_DEADLINE);
+    fclose(f);
+    spiBus_release(SPI_BUS_CLIENT_PREFETCH);
+
+    if (failed)
+    {
+        ESP_LOGE(TAG, "Reading %s failed after %" PRIu32 " bytes", request->path, request->length);
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+
+static const asset_pack_entry_t * find_pack_entry(const char *name)
+{
+    uint32_t hash = assetFormat_hashName(name);
+
+    for (uint16_t ix = 0u; ix < priv_pack_entry_count; ix++)
+    {
+        if (priv_pack_toc[ix].name_hash == hash)
+        {
+            return &priv_pack_toc[ix];
+        }
+    }
+
+    return NULL;
+}
@@ -8,7 +8,30 @@
 #ifndef MAIN_SDCARD_H_
 #define MAIN_SDCARD_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+
+/* A background read, see sdCard_Prefetch_file(). */
+typedef struct
+{
+    char path[32];
+    void * buffer;
+    uint32_t size;
+    uint32_t length;            /* Bytes read */
+    esp_err_t result;           /* ESP_FAIL if the file was cut short by a read error */
+    atomic_bool done;
+} sdCard_prefetch_t;
+
 extern void sdCard_init(void);
-extern void sdCard_Read_bmp_file(const char *path, uint16_t * output_buffer);
+extern esp_err_t sdCard_Read_bmp_file(const char *path, uint16_t * output_buffer, uint16_t width, uint16_t height);
+extern esp_err_t sdCard_Read_rgb565_file(const char *path, uint16_t * output_buffer, uint16_t width, uint16_t height);
+extern esp_err_t sdCard_Open_asset_pack(const char *path);
+extern esp_err_t sdCard_Read_asset_pack_entry(const char *name, uint16_t * output_buffer, uint16_t width, uint16_t height);
+extern void sdCard_Close_asset_pack(void);
+extern esp_err_t sdCard_Write_file(const char *path, const void * data, uint32_t length, bool append);
+extern esp_err_t sdCard_Prefetch_file(sdCard_prefetch_t * request, const char *path, void * buffer, uint32_t size);
+extern bool sdCard_Prefetch_done(const sdCard_prefetch_t * request);
 
 #endif /* MAIN_SDCARD_H_ */
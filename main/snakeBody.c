@@ -0,0 +1,152 @@
+/*
+ * snakeBody.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <string.h>
+#include <assert.h>
+
+#include "snakeBody.h"
+
+/*
+**====================================================================================
+** Private macro definitions
+**====================================================================================
+*/
+
+#define RING_MASK   (SNAKE_BODY_RING_SIZE - 1u)
+
+_Static_assert(SNAKE_MAX_LENGTH <= GRID_CELLS, "The snake cannot be longer than the grid");
+_Static_assert((SNAKE_MAX_LENGTH >= 1u) && (SNAKE_MAX_LENGTH <= SNAKE_BODY_RING_SIZE), "Ring too small");
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static void set_occupied(snakeBody_t * body, grid_cell_t cell, bool occupied);
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+/* One segment long, on the given cell. */
+void snakeBody_reset(snakeBody_t * body, grid_cell_t head)
+{
+    assert(head < GRID_CELLS);
+
+    memset(body->occupied, 0, sizeof(body->occupied));
+    freeCells_reset(&body->free);
+    body->head = 0u;
+    body->length = 1u;
+    body->cells[0] = head;
+    body->vacated = head;
+    set_occupied(body, head, true);
+}
+
+
+/* Takes a cell the snake never goes onto, such as a wall, out of the free cells, so no food is
+ * placed there. Until the next reset. */
+void snakeBody_block(snakeBody_t * body, grid_cell_t cell)
+{
+    assert(!snakeBody_isOccupied(body, cell));
+    freeCells_take(&body->free, cell);
+}
+
+
+/* Moves the head onto new_head, which must be next to it. The tail leaves its cell first, so the
+ * head may follow it onto that cell. Returns false and leaves the body as it was if the head
+ * would run into the body. */
+bool snakeBody_move(snakeBody_t * body, grid_cell_t new_head)
+{
+    grid_cell_t tail = snakeBody_getSegment(body, body->length - 1u);
+
+    assert(new_head < GRID_CELLS);
+
+    set_occupied(body, tail, false);
+
+    if (snakeBody_isOccupied(body, new_head))
+    {
+        set_occupied(body, tail, true);
+        return false;
+    }
+
+    body->vacated = tail;
+    body->head = (body->head - 1u) & RING_MASK;
+    body->cells[body->head] = new_head;
+    set_occupied(body, new_head, true);
+
+    return true;
+}
+
+
+/* Adds a segment behind the tail, on the cell the tail left in the last move. Returns false if the
+ * snake is as long as it can get or that cell has been taken since. */
+bool snakeBody_grow(snakeBody_t * body)
+{
+    if ((body->length == SNAKE_MAX_LENGTH) || snakeBody_isOccupied(body, body->vacated))
+    {
+        return false;
+    }
+
+    body->cells[(body->head + body->length) & RING_MASK] = body->vacated;
+    body->length++;
+    set_occupied(body, body->vacated, true);
+
+    return true;
+}
+
+
+bool snakeBody_isOccupied(const snakeBody_t * body, grid_cell_t cell)
+{
+    return (body->occupied[cell >> 5] & (1u << (cell & 31u))) != 0u;
+}
+
+
+/* Index 0 is the head, snakeBody_getLength() - 1 the tail. */
+grid_cell_t snakeBody_getSegment(const snakeBody_t * body, uint16_t index)
+{
+    assert(index < body->length);
+    return body->cells[(body->head + index) & RING_MASK];
+}
+
+
+uint16_t snakeBody_getLength(const snakeBody_t * body)
+{
+    return body->length;
+}
+
+
+const freeCells_t * snakeBody_getFreeCells(const snakeBody_t * body)
+{
+    return &body->free;
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+static void set_occupied(snakeBody_t * body, grid_cell_t cell, bool occupied)
+{
+    if (occupied)
+    {
+        body->occupied[cell >> 5] |= (1u << (cell & 31u));
+        freeCells_take(&body->free, cell);
+    }
+    else
+    {
+        body->occupied[cell >> 5] &= ~(1u << (cell & 31u));
+        freeCells_release(&body->free, cell);
+    }
+}
@@ -0,0 +1,46 @@
+/*
+ * snakeBody.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_SNAKEBODY_H_
+#define MAIN_SNAKEBODY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "grid.h"
+#include "freeCells.h"
+
+/* Longest the snake can grow. Can be lowered from the build, the whole grid is the upper limit. */
+#ifndef SNAKE_MAX_LENGTH
+#define SNAKE_MAX_LENGTH        GRID_CELLS
+#endif
+
+/* Ring buffer size: the smallest power of two that holds SNAKE_MAX_LENGTH segments. */
+#define SNAKE_BODY_RING_SIZE    ((SNAKE_MAX_LENGTH <= 64u) ? 64u : ((SNAKE_MAX_LENGTH <= 128u) ? 128u : 256u))
+
+/* The cells the snake covers, head first, in a ring buffer so that moving never shifts the body,
+ * plus a bitmap of the same cells so that checking a cell never scans it. The cells it does not
+ * cover are kept in a free cell set, for placing food. */
+typedef struct
+{
+    grid_cell_t cells[SNAKE_BODY_RING_SIZE];
+    uint32_t occupied[(GRID_CELLS + 31u) / 32u];
+    uint16_t head;              /* Ring index of the head, the other segments follow it */
+    uint16_t length;
+    grid_cell_t vacated;        /* Cell the tail left in the last move */
+    freeCells_t free;
+} snakeBody_t;
+
+extern void snakeBody_reset(snakeBody_t * body, grid_cell_t head);
+extern void snakeBody_block(snakeBody_t * body, grid_cell_t cell);
+extern bool snakeBody_move(snakeBody_t * body, grid_cell_t new_head);
+extern bool snakeBody_grow(snakeBody_t * body);
+extern bool snakeBody_isOccupied(const snakeBody_t * body, grid_cell_t cell);
+extern grid_cell_t snakeBody_getSegment(const snakeBody_t * body, uint16_t index);
+extern uint16_t snakeBody_getLength(const snakeBody_t * body);
+extern const freeCells_t * snakeBody_getFreeCells(const snakeBody_t * body);
+
+#endif /* MAIN_SNAKEBODY_H_ */
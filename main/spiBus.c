@@ -0,0 +1,220 @@
+/*
+ * spiBus.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdio.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+#include "display.h"
+#include "spiBus.h"
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+#define PIN_NUM_CLK   12	/* SPI Clock pin */
+#define PIN_NUM_MOSI  11	/* SPI Master Out, Slave in  - The ESP32 transmits data over this pin */
+#define PIN_NUM_MISO  13	/* SPI Master In, Slave Out  - The ESP32 receives data over this pin. */
+
+#define SPI_BUS_NO_OWNER    (-1)
+
+/*
+**====================================================================================
+** Private type definitions
+**====================================================================================
+*/
+
+typedef struct
+{
+    SemaphoreHandle_t granted;      /* Given when the bus is handed over to this client */
+    bool waiting;
+    int64_t requested_us;
+    int64_t deadline_us;
+    int64_t acquired_us;
+    spiBus_stats_t stats;
+} bus_client_t;
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static int pick_next_owner(void);
+
+/*
+**====================================================================================
+** Private variable declarations
+**====================================================================================
+*/
+
+static portMUX_TYPE priv_lock = portMUX_INITIALIZER_UNLOCKED;
+static int priv_owner = SPI_BUS_NO_OWNER;
+static bus_client_t priv_clients[NUMBER_OF_SPI_BUS_CLIENTS];
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+/* Initializes the SPI peripheral, but does not yet add any devices on it. */
+bool spiBus_init(void)
+{
+    esp_err_t ret;
+
+    printf("Setting up SPI peripheral\n");
+
+    spi_bus_config_t bus_cfg =
+    {
+        .mosi_io_num = PIN_NUM_MOSI,
+        .miso_io_num = PIN_NUM_MISO,
+        .sclk_io_num = PIN_NUM_CLK,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = DISPLAY_MAX_TRANSFER_SIZE,
+    };
+
+    ret = spi_bus_initialize(SPI_BUS_HOST, &bus_cfg, SPI_DMA_CH_AUTO);
+
+    if (ret != ESP_OK)
+    {
+        printf("Failed to initialize bus.\n");
+        return false;
+    }
+
+    for (int ix = 0; ix < NUMBER_OF_SPI_BUS_CLIENTS; ix++)
+    {
+        priv_clients[ix].granted = xSemaphoreCreateBinary();
+        assert(priv_clients[ix].granted);
+    }
+
+    return true;
+}
+
+
+/* Blocks until the client owns the bus. Each client can be used by one task at a time, and must
+ * not acquire the bus again before releasing it. */
+void spiBus_acquire(spiBus_client_t client, int64_t deadline_us)
+{
+    bus_client_t * self = &priv_clients[client];
+    int64_t now_us = esp_timer_get_time();
+    bool granted;
+
+    portENTER_CRITICAL(&priv_lock);
+    assert(!self->waiting && (priv_owner != (int)client));
+    self->requested_us = now_us;
+    self->deadline_us = deadline_us;
+    /* Nobody waits while the bus is free, spiBus_release() hands it straight to the next client. */
+    granted = (priv_owner == SPI_BUS_NO_OWNER);
+    if (granted)
+    {
+        priv_owner = client;
+    }
+    else
+    {
+        self->waiting = true;
+    }
+    portEXIT_CRITICAL(&priv_lock);
+
+    if (!granted)
+    {
+        xSemaphoreTake(self->granted, portMAX_DELAY);
+        now_us = esp_timer_get_time();
+    }
+
+    portENTER_CRITICAL(&priv_lock);
+    self->acquired_us = now_us;
+    self->stats.acquisitions++;
+    self->stats.wait_total_us += now_us - self->requested_us;
+    if ((now_us - self->requested_us) > self->stats.wait_max_us)
+    {
+        self->stats.wait_max_us = now_us - self->requested_us;
+    }
+    if (now_us > deadline_us)
+    {
+        self->stats.late++;
+    }
+    portEXIT_CRITICAL(&priv_lock);
+}
+
+
+/* Call once the client's transfers have completed. */
+void spiBus_release(spiBus_client_t client)
+{
+    int64_t now_us = esp_timer_get_time();
+    int next;
+
+    portENTER_CRITICAL(&priv_lock);
+    assert(priv_owner == (int)client);
+    priv_clients[client].stats.busy_us += now_us - priv_clients[client].acquired_us;
+
+    next = pick_next_owner();
+    if (next != SPI_BUS_NO_OWNER)
+    {
+        priv_clients[next].waiting = false;
+    }
+    priv_owner = next;
+    portEXIT_CRITICAL(&priv_lock);
+
+    if (next != SPI_BUS_NO_OWNER)
+    {
+        xSemaphoreGive(priv_clients[next].granted);
+    }
+}
+
+
+void spiBus_getStats(spiBus_client_t client, spiBus_stats_t * stats)
+{
+    portENTER_CRITICAL(&priv_lock);
+    *stats = priv_clients[client].stats;
+    portEXIT_CRITICAL(&priv_lock);
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+/* The waiting client with the earliest deadline, or the one that asked first with
+ * CONFIG_ENGINAATOR_SPI_BUS_FIFO. Called with priv_lock held. */
+static int pick_next_owner(void)
+{
+    int next = SPI_BUS_NO_OWNER;
+
+    for (int ix = 0; ix < NUMBER_OF_SPI_BUS_CLIENTS; ix++)
+    {
+        const bus_client_t * client = &priv_clients[ix];
+
+        if (!client->waiting)
+        {
+            continue;
+        }
+
+#ifdef CONFIG_ENGINAATOR_SPI_BUS_FIFO
+        if ((next == SPI_BUS_NO_OWNER) || (client->requested_us < priv_clients[next].requested_us))
+#else
+        if ((next == SPI_BUS_NO_OWNER) || (client->deadline_us < priv_clients[next].deadline_us))
+#endif
+        {
+            next = ix;
+        }
+    }
+
+    return next;
+}
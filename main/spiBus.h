@@ -0,0 +1,46 @@
+/*
+ * spiBus.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_SPIBUS_H_
+#define MAIN_SPIBUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/spi_master.h"
+
+/* The display and the SD card share this bus. */
+#define SPI_BUS_HOST SPI2_HOST
+
+#define SPI_BUS_NO_DEADLINE INT64_MAX
+
+/* Everyone who puts transfers on the bus. A client holds the bus from its first transfer until the
+ * last one has completed, so an SD read never stalls in the middle of a display flush and the other
+ * way round. When the bus is given back it goes to the waiting client with the earliest deadline,
+ * between equal deadlines to the one listed first here. */
+typedef enum
+{
+    SPI_BUS_CLIENT_DISPLAY,     /* Frame flushes */
+    SPI_BUS_CLIENT_SDCARD,      /* SD reads a task is waiting for */
+    SPI_BUS_CLIENT_PREFETCH,    /* Background SD reads, they get the gaps between the others */
+
+    NUMBER_OF_SPI_BUS_CLIENTS
+} spiBus_client_t;
+
+typedef struct
+{
+    uint32_t acquisitions;
+    uint32_t late;              /* Got the bus after their deadline */
+    int64_t busy_us;            /* Holding the bus */
+    int64_t wait_total_us;      /* Waiting for another client to give it back */
+    int64_t wait_max_us;
+} spiBus_stats_t;
+
+extern bool spiBus_init(void);
+extern void spiBus_acquire(spiBus_client_t client, int64_t deadline_us);
+extern void spiBus_release(spiBus_client_t client);
+extern void spiBus_getStats(spiBus_client_t client, spiBus_stats_t * stats);
+
+#endif /* MAIN_SPIBUS_H_ */
@@ -0,0 +1,215 @@
+/*
+ * spritePool.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+
+#include "blit.h"
+#include "spritePool.h"
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+/* Sprites are only read by the CPU when composing frames, so the pool goes into PSRAM when
+ * there is some, and falls back to internal DMA capable RAM otherwise. */
+#define POOL_PRIMARY_CAPS       (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#define POOL_FALLBACK_CAPS      (MALLOC_CAP_DMA)
+
+/*
+**====================================================================================
+** Private type definitions
+**====================================================================================
+*/
+
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    uint8_t bits_per_pixel; /* 16 for RGB565, 4 or 8 for indexed */
+} pool_class_def_t;
+
+typedef struct
+{
+    uint8_t * base;
+    uint32_t slot_bytes;
+    uint8_t slots;          /* As reserved */
+    uint8_t in_use;         /* Slots 0 to in_use - 1 have been handed out */
+    uint32_t failed_allocs;
+} pool_class_t;
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static uint32_t get_slot_bytes(const pool_class_def_t * def);
+
+/*
+**====================================================================================
+** Private variable declarations
+**====================================================================================
+*/
+
+/* Every size and format assets.c keeps sprites in. */
+static const pool_class_def_t priv_class_defs[NUMBER_OF_SPRITE_CLASSES] =
+{
+    [SPRITE_CLASS_20x20]         = {  20, 20,  4 },
+    [SPRITE_CLASS_100x40]        = { 100, 40,  4 },
+    [SPRITE_CLASS_100x20]        = { 100, 20,  4 },
+    [SPRITE_CLASS_156x40]        = { 156, 40,  8 },
+
+    [SPRITE_CLASS_20x20_RGB565]  = {  20, 20, 16 },
+    [SPRITE_CLASS_100x40_RGB565] = { 100, 40, 16 },
+    [SPRITE_CLASS_100x20_RGB565] = { 100, 20, 16 },
+    [SPRITE_CLASS_156x40_RGB565] = { 156, 40, 16 },
+};
+
+static pool_class_t priv_classes[NUMBER_OF_SPRITE_CLASSES];
+static uint8_t * priv_pool_memory;
+static uint32_t priv_pool_size;
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+/* Adds a slot to the class with exactly these dimensions and format. Returns false if there is no
+ * such class or it has no room for another slot. Only before spritePool_init(). */
+bool spritePool_reserve(uint16_t width, uint16_t height, uint8_t bits_per_pixel)
+{
+    for (int ix = 0; ix < NUMBER_OF_SPRITE_CLASSES; ix++)
+    {
+        const pool_class_def_t * def = &priv_class_defs[ix];
+
+        if ((def->width == width) && (def->height == height) && (def->bits_per_pixel == bits_per_pixel))
+        {
+            if (priv_classes[ix].slots == UINT8_MAX)
+            {
+                return false;
+            }
+            priv_classes[ix].slots++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/* Allocates the memory of every reserved slot at once. Nothing is allocated from the heap for
+ * sprites after this. */
+void spritePool_init(void)
+{
+    uint8_t * dest;
+
+    priv_pool_size = 0u;
+    for (int ix = 0; ix < NUMBER_OF_SPRITE_CLASSES; ix++)
+    {
+        priv_pool_size += get_slot_bytes(&priv_class_defs[ix]) * priv_classes[ix].slots;
+    }
+
+    priv_pool_memory = heap_caps_malloc(priv_pool_size, POOL_PRIMARY_CAPS);
+    if (priv_pool_memory == NULL)
+    {
+        priv_pool_memory = heap_caps_malloc(priv_pool_size, POOL_FALLBACK_CAPS);
+    }
+    assert(priv_pool_memory);
+    memset(priv_pool_memory, 0, priv_pool_size);
+
+    dest = priv_pool_memory;
+    for (int ix = 0; ix < NUMBER_OF_SPRITE_CLASSES; ix++)
+    {
+        priv_classes[ix].base = dest;
+        priv_classes[ix].slot_bytes = get_slot_bytes(&priv_class_defs[ix]);
+
+        dest += priv_classes[ix].slot_bytes * priv_classes[ix].slots;
+    }
+}
+
+
+/* Returns the next slot of the class with exactly these dimensions and format, or NULL if every
+ * reserved slot has been handed out or there is no such class. Assets are never unloaded, so slots
+ * are not given back: a class is filled in order, like a bump allocator. */
+void * spritePool_alloc(uint16_t width, uint16_t height, uint8_t bits_per_pixel)
+{
+    for (int ix = 0; ix < NUMBER_OF_SPRITE_CLASSES; ix++)
+    {
+        const pool_class_def_t * def = &priv_class_defs[ix];
+        pool_class_t * pool = &priv_classes[ix];
+
+        if ((def->width != width) || (def->height != height) || (def->bits_per_pixel != bits_per_pixel))
+        {
+            continue;
+        }
+
+        if (pool->in_use == pool->slots)
+        {
+            pool->failed_allocs++;
+            return NULL;
+        }
+
+        return pool->base + (pool->in_use++ * pool->slot_bytes);
+    }
+
+    return NULL;
+}
+
+
+void spritePool_getStats(sprite_class_t sprite_class, spritePool_stats_t * stats)
+{
+    const pool_class_def_t * def = &priv_class_defs[sprite_class];
+    const pool_class_t * pool = &priv_classes[sprite_class];
+
+    stats->width = def->width;
+    stats->height = def->height;
+    stats->bits_per_pixel = def->bits_per_pixel;
+    stats->slots = pool->slots;
+    stats->in_use = pool->in_use;
+    stats->failed_allocs = pool->failed_allocs;
+}
+
+
+uint32_t spritePool_getTotalBytes(void)
+{
+    return priv_pool_size;
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+/* Rounded up to a whole word, so every slot starts word aligned. */
+static uint32_t get_slot_bytes(const pool_class_def_t * def)
+{
+    uint32_t bytes;
+
+    if (def->bits_per_pixel == 16u)
+    {
+        bytes = def->width * def->height * sizeof(uint16_t);
+    }
+    else
+    {
+        bytes = (BLIT_PALETTE_ENTRIES(def->bits_per_pixel) * sizeof(uint16_t)) +
+                (BLIT_INDEXED_ROW_BYTES(def->width, def->bits_per_pixel) * def->height);
+    }
+
+    return (bytes + 3u) & ~3u;
+}
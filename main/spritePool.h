@@ -0,0 +1,51 @@
+/*
+ * spritePool.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_SPRITEPOOL_H_
+#define MAIN_SPRITEPOOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Every sprite size the game uses has its own class of fixed size slots, indexed and RGB565. A slot
+ * holds the RGB565 pixels of a sprite, or for an indexed one (4 or 8 bits per pixel) its palette
+ * followed by the indices, see blit.h. How many slots each class has is only known once the images
+ * have been looked at, so every sprite reserves its slot with spritePool_reserve() before
+ * spritePool_init() allocates them all in one block. Sprites are loaded once and never unloaded, so
+ * slots are handed out in order and never given back. */
+typedef enum
+{
+    SPRITE_CLASS_20x20,             /* snake parts, fruits */
+    SPRITE_CLASS_100x40,            /* menu buttons */
+    SPRITE_CLASS_100x20,            /* speed selector */
+    SPRITE_CLASS_156x40,            /* enginaator logo */
+
+    /* The same sprites when they have more colours than their indexed format holds */
+    SPRITE_CLASS_20x20_RGB565,
+    SPRITE_CLASS_100x40_RGB565,
+    SPRITE_CLASS_100x20_RGB565,
+    SPRITE_CLASS_156x40_RGB565,
+
+    NUMBER_OF_SPRITE_CLASSES
+} sprite_class_t;
+
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    uint8_t bits_per_pixel;
+    uint8_t slots;
+    uint8_t in_use;
+    uint32_t failed_allocs;
+} spritePool_stats_t;
+
+extern bool spritePool_reserve(uint16_t width, uint16_t height, uint8_t bits_per_pixel);
+extern void spritePool_init(void);
+extern void * spritePool_alloc(uint16_t width, uint16_t height, uint8_t bits_per_pixel);
+extern void spritePool_getStats(sprite_class_t sprite_class, spritePool_stats_t * stats);
+extern uint32_t spritePool_getTotalBytes(void);
+
+#endif /* MAIN_SPRITEPOOL_H_ */
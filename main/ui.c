@@ -0,0 +1,277 @@
+/*
+ * ui.c
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+/*
+**====================================================================================
+** Imported definitions
+**====================================================================================
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "display.h"
+#include "assets.h"
+#include "blit.h"
+#include "ui.h"
+
+/*
+**====================================================================================
+** Private constant definitions
+**====================================================================================
+*/
+
+#define UI_BACKGROUND_COLOR     COLOR_WHITE
+
+/* Most states a widget has, and its largest sprite */
+#define UI_MAX_STATES           3u
+#define UI_WIDGET_MAX_PIXELS    (100u * 40u)
+
+#define UI_SCREEN(screen)       (1u << (screen))
+
+/*
+**====================================================================================
+** Private type definitions
+**====================================================================================
+*/
+
+typedef enum
+{
+    UI_BUTTON_LEVEL1,
+    UI_BUTTON_LEVEL2,
+    UI_BUTTON_LEVEL3,
+    UI_BUTTON_SETTINGS,
+    UI_SPEED_SELECTOR,
+
+    NUMBER_OF_UI_WIDGETS
+} ui_widget_id_t;
+
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+    uint8_t screens;                            /* UI_SCREEN() of every screen it is shown on */
+    asset_handle_t sprites[UI_MAX_STATES];      /* Buttons: normal and highlighted. Selector: one per speed */
+} ui_widget_def_t;
+
+typedef struct
+{
+    uint8_t state;              /* Index into sprites */
+    bool visible;
+    bool dirty;                 /* Has to be drawn */
+    bool uncovered;             /* Has been hidden, what was under it has to be drawn */
+} ui_widget_t;
+
+/*
+**====================================================================================
+** Private function forward declarations
+**====================================================================================
+*/
+
+static uint8_t get_state(ui_widget_id_t id, const game_snapshot_t * snapshot);
+static blit_rect_t get_rect(ui_widget_id_t id);
+static void draw_widget(ui_widget_id_t id);
+static void mark_overlapping(const blit_rect_t * rect, int first);
+
+/*
+**====================================================================================
+** Private variable declarations
+**====================================================================================
+*/
+
+/* Later widgets are drawn over earlier ones. The settings screen is drawn over the menu. */
+static const ui_widget_def_t priv_widget_defs[NUMBER_OF_UI_WIDGETS] =
+{
+    [UI_BUTTON_LEVEL1]   = {  50,  50, UI_SCREEN(SNAPSHOT_SCREEN_MAIN_MENU) | UI_SCREEN(SNAPSHOT_SCREEN_SETTINGS), { ASSET_LVL1, ASSET_LVL1_HIGHLIGHTED } },
+    [UI_BUTTON_LEVEL2]   = { 150,  50, UI_SCREEN(SNAPSHOT_SCREEN_MAIN_MENU) | UI_SCREEN(SNAPSHOT_SCREEN_SETTINGS), { ASSET_LVL2, ASSET_LVL2_HIGHLIGHTED } },
+    [UI_BUTTON_LEVEL3]   = {  50, 100, UI_SCREEN(SNAPSHOT_SCREEN_MAIN_MENU) | UI_SCREEN(SNAPSHOT_SCREEN_SETTINGS), { ASSET_LVL3, ASSET_LVL3_HIGHLIGHTED } },
+    [UI_BUTTON_SETTINGS] = { 150, 100, UI_SCREEN(SNAPSHOT_SCREEN_MAIN_MENU) | UI_SCREEN(SNAPSHOT_SCREEN_SETTINGS), { ASSET_OPTIONS, ASSET_OPTIONS_HIGHLIGHTED } },
+    [UI_SPEED_SELECTOR]  = { 100,  50, UI_SCREEN(SNAPSHOT_SCREEN_SETTINGS), { ASSET_SPEED1, ASSET_SPEED2, ASSET_SPEED3 } },
+};
+
+static ui_widget_t priv_widgets[NUMBER_OF_UI_WIDGETS];
+
+/* The screen shows something else, the background has to be drawn first */
+static bool priv_redraw_all;
+
+/* A widget is drawn here and then sent */
+static uint16_t priv_widget_pixels[UI_WIDGET_MAX_PIXELS];
+
+/*
+**====================================================================================
+** Public function definitions
+**====================================================================================
+*/
+
+void ui_init(void)
+{
+    for (int ix = 0; ix < NUMBER_OF_UI_WIDGETS; ix++)
+    {
+        priv_widgets[ix] = (ui_widget_t){ .state = 0u, .visible = false, .dirty = false, .uncovered = false };
+    }
+    priv_redraw_all = true;
+}
+
+
+/* Brings the widgets up to date with the snapshot. Widgets that appear or change state are marked
+ * dirty, ones that disappear leave their area to be cleared. */
+void ui_update(const game_snapshot_t * snapshot)
+{
+    if (snapshot->screen == SNAPSHOT_SCREEN_GAME)
+    {
+        /* The game draws over all of it, the next menu starts from scratch. */
+        ui_init();
+        return;
+    }
+
+    for (int ix = 0; ix < NUMBER_OF_UI_WIDGETS; ix++)
+    {
+        ui_widget_t * widget = &priv_widgets[ix];
+        bool visible = (priv_widget_defs[ix].screens & UI_SCREEN(snapshot->screen)) != 0u;
+        uint8_t state = get_state((ui_widget_id_t)ix, snapshot);
+
+        if (visible != widget->visible)
+        {
+            widget->visible = visible;
+            widget->dirty = visible;
+            widget->uncovered = !visible;
+        }
+        else if (visible && (state != widget->state))
+        {
+            widget->dirty = true;
+        }
+        widget->state = state;
+    }
+}
+
+
+/* True if ui_draw() has anything to send. */
+bool ui_isDirty(void)
+{
+    if (priv_redraw_all)
+    {
+        return true;
+    }
+
+    for (int ix = 0; ix < NUMBER_OF_UI_WIDGETS; ix++)
+    {
+        if (priv_widgets[ix].dirty || priv_widgets[ix].uncovered)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/* Sends the dirty widgets to the panel, after clearing where hidden ones were. A widget that is
+ * drawn again takes the widgets over it along. The caller holds the SPI bus for the display and
+ * waits for the display to be idle afterwards. */
+void ui_draw(void)
+{
+    if (priv_redraw_all)
+    {
+        display_fillRectangle(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, UI_BACKGROUND_COLOR);
+        for (int ix = 0; ix < NUMBER_OF_UI_WIDGETS; ix++)
+        {
+            priv_widgets[ix].dirty = priv_widgets[ix].visible;
+            priv_widgets[ix].uncovered = false;
+        }
+        priv_redraw_all = false;
+    }
+
+    for (int ix = 0; ix < NUMBER_OF_UI_WIDGETS; ix++)
+    {
+        if (priv_widgets[ix].uncovered)
+        {
+            blit_rect_t rect = get_rect((ui_widget_id_t)ix);
+
+            display_fillRectangle(rect.x, rect.y, rect.width, rect.height, UI_BACKGROUND_COLOR);
+            mark_overlapping(&rect, 0);
+            priv_widgets[ix].uncovered = false;
+        }
+    }
+
+    for (int ix = 0; ix < NUMBER_OF_UI_WIDGETS; ix++)
+    {
+        if (priv_widgets[ix].visible && priv_widgets[ix].dirty)
+        {
+            blit_rect_t rect = get_rect((ui_widget_id_t)ix);
+
+            draw_widget((ui_widget_id_t)ix);
+            mark_overlapping(&rect, ix + 1);
+            priv_widgets[ix].dirty = false;
+        }
+    }
+}
+
+/*
+**====================================================================================
+** Private function definitions
+**====================================================================================
+*/
+
+/* The state the snapshot puts the widget in. */
+static uint8_t get_state(ui_widget_id_t id, const game_snapshot_t * snapshot)
+{
+    if (id == UI_SPEED_SELECTOR)
+    {
+        return ((snapshot->speed >= 1u) && (snapshot->speed <= UI_MAX_STATES)) ? (snapshot->speed - 1u) : 0u;
+    }
+
+    /* The buttons are numbered from 1 in the snapshot */
+    return (snapshot->menu_selection == (id + 1u)) ? 1u : 0u;
+}
+
+
+/* Where the widget is on the screen, the size of its current sprite. */
+static blit_rect_t get_rect(ui_widget_id_t id)
+{
+    const ui_widget_def_t * def = &priv_widget_defs[id];
+    const asset_sprite_t * sprite = assets_get(def->sprites[priv_widgets[id].state]);
+
+    return (blit_rect_t){ def->x, def->y, (int16_t)sprite->width, (int16_t)sprite->height };
+}
+
+
+/* Draws the widget into priv_widget_pixels and sends it. Keyed sprites are drawn over the
+ * background colour. */
+static void draw_widget(ui_widget_id_t id)
+{
+    asset_handle_t handle = priv_widget_defs[id].sprites[priv_widgets[id].state];
+    const asset_sprite_t * sprite = assets_get(handle);
+    blit_rect_t rect = get_rect(id);
+    blit_surface_t surface = { .pixels = priv_widget_pixels, .x = rect.x, .y = rect.y,
+                               .width = (uint16_t)rect.width, .height = (uint16_t)rect.height, .stride = (uint16_t)rect.width };
+
+    assert((uint32_t)(rect.width * rect.height) <= UI_WIDGET_MAX_PIXELS);
+
+    if (sprite->keyed)
+    {
+        blit_fill(&surface, rect.x, rect.y, rect.width, rect.height, UI_BACKGROUND_COLOR);
+    }
+    assets_draw(&surface, rect.x, rect.y, handle, &rect);
+
+    display_drawBitmap(rect.x, rect.y, rect.width, rect.height, priv_widget_pixels);
+}
+
+
+/* Marks the visible widgets from first on that overlap rect to be drawn again. */
+static void mark_overlapping(const blit_rect_t * rect, int first)
+{
+    for (int ix = first; ix < NUMBER_OF_UI_WIDGETS; ix++)
+    {
+        blit_rect_t other = get_rect((ui_widget_id_t)ix);
+
+        if (priv_widgets[ix].visible &&
+            (other.x < (rect->x + rect->width)) && (rect->x < (other.x + other.width)) &&
+            (other.y < (rect->y + rect->height)) && (rect->y < (other.y + other.height)))
+        {
+            priv_widgets[ix].dirty = true;
+        }
+    }
+}
@@ -0,0 +1,25 @@
+/*
+ * ui.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef MAIN_UI_H_
+#define MAIN_UI_H_
+
+#include <stdbool.h>
+
+#include "gameSnapshot.h"
+
+/* The menu and settings screens as retained widgets: the four menu buttons and the speed selector.
+ * Each one knows where it is, the sprite of each of its states and whether it has to be drawn
+ * again. ui_update() takes the selection from a snapshot and marks the widgets whose state
+ * changed, ui_draw() sends only those to the panel. A menu nobody touches sends nothing. Both are
+ * for the render task only. */
+
+extern void ui_init(void);
+extern void ui_update(const game_snapshot_t * snapshot);
+extern bool ui_isDirty(void);
+extern void ui_draw(void);
+
+#endif /* MAIN_UI_H_ */